@@ -0,0 +1,295 @@
+/**
+ * File: life-bench.cpp
+ * --------------------
+ * A headless benchmark driver for the Life engines.  It loads a colony
+ * file or seeds a random board, runs a fixed number of generations with
+ * no display at all, and reports generations per second, cell updates
+ * per second and peak resident memory.
+ *
+ * This file has its own main, so it isn't part of the life target.
+ * It needs no window system; build it against the stub library:
+ *
+ *     g++ -O3 -IStanfordCPPLib -o life-bench life-bench.cpp life-colony.cpp \
+ *         life-engine.cpp life-classic.cpp life-bitboard.cpp life-buffered.cpp \
+ *         life-parallel.cpp life-sparse.cpp life-plane.cpp life-tiled.cpp \
+ *         life-threadpool.cpp life-hashlife.cpp life-cycles.cpp life-rule.cpp \
+ *         life-record.cpp \
+ *         -LStanfordCPPLib -lStubCPPLib -lpthread
+ *
+ * Usage: life-bench [options]
+ *
+ *     --file <colony>        load a colony file or RLE pattern
+ *     --random <rows>x<cols> seed a random board instead (default 1000x1000)
+ *     --density <p>          chance that a random cell starts alive (0.5)
+ *     --seed <n>             random seed (1)
+ *     --generations <n>      generations to run (1000)
+ *     --engine <name>        Classic, Bitboard, DoubleBuffered, ... (Bitboard)
+ *     --threads <n>          threads for the Parallel engine (0 = one per core)
+ *     --wrap                 wrap the edges around (a toroidal board)
+ *     --rule <rule>          run under another rule, such as B36/S23 or HighLife,
+ *                            overriding any rule in an RLE header
+ *     --record <file>        record every generation to file as it's run
+ *     --keyframes <n>        generations between keyframes in the recording (100)
+ *     --until-stable         stop early once the colony dies out, settles or
+ *                            starts to oscillate
+ *     --hashlife             run the colony on HashLife's unbounded plane instead
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include "life-engine.h"
+#include "life-colony.h"
+#include "life-hashlife.h"
+#include "life-cycles.h"
+#include "life-record.h"
+using namespace std;
+
+struct BenchOptions {
+    string file;
+    int numRows;
+    int numCols;
+    double density;
+    unsigned long long seed;
+    long long generations;
+    LifeEngine::EngineType type;
+    int numThreads;
+    bool wrap;
+    bool ruleGiven;
+    LifeRule rule;
+    string recordFile;
+    int keyframeInterval;
+    bool untilStable;
+    bool hashlife;
+};
+
+static void parseOptions(int argc, char *argv[], BenchOptions& options);
+static void usage(const string& problem);
+static double now();
+static long peakMemoryKB();
+static long long countLiveCells(const LifeEngine& engine);
+static void loadColony(const BenchOptions& options, LifeEngine& engine);
+static void runEngine(const BenchOptions& options);
+static void runHashLife(const BenchOptions& options);
+
+int main(int argc, char *argv[]) {
+    BenchOptions options;
+    parseOptions(argc, argv, options);
+    if (options.hashlife) {
+        runHashLife(options);
+    } else {
+        runEngine(options);
+    }
+    cout << "peak RSS:          " << peakMemoryKB() << " KB" << endl;
+    return 0;
+}
+
+static void parseOptions(int argc, char *argv[], BenchOptions& options) {
+    options.numRows = 1000;
+    options.numCols = 1000;
+    options.density = 0.5;
+    options.seed = 1;
+    options.generations = 1000;
+    options.type = LifeEngine::Bitboard;
+    options.numThreads = 0;
+    options.wrap = false;
+    options.ruleGiven = false;
+    options.keyframeInterval = LifeRecorder::kDefaultKeyframeInterval;
+    options.untilStable = false;
+    options.hashlife = false;
+    for (int i = 1; i < argc; i++) {
+        string flag = argv[i];
+        if (flag == "--hashlife") {
+            options.hashlife = true;
+            continue;
+        }
+        if (flag == "--wrap") {
+            options.wrap = true;
+            continue;
+        }
+        if (flag == "--until-stable") {
+            options.untilStable = true;
+            continue;
+        }
+        if (i + 1 >= argc) usage("missing value for " + flag);
+        string value = argv[++i];
+        istringstream in(value);
+        bool ok = true;
+        if (flag == "--file") {
+            options.file = value;
+        } else if (flag == "--random") {
+            char by = 0;
+            ok = (in >> options.numRows >> by >> options.numCols) && by == 'x'
+                 && options.numRows > 0 && options.numCols > 0;
+        } else if (flag == "--density") {
+            ok = bool(in >> options.density);
+        } else if (flag == "--seed") {
+            ok = bool(in >> options.seed);
+        } else if (flag == "--generations") {
+            ok = (in >> options.generations) && options.generations >= 0;
+        } else if (flag == "--engine") {
+            ok = LifeEngine::nameToType(value, options.type);
+        } else if (flag == "--threads") {
+            ok = (in >> options.numThreads) && options.numThreads >= 0;
+        } else if (flag == "--rule") {
+            ok = options.ruleGiven = LifeRule::parse(value, options.rule);
+        } else if (flag == "--record") {
+            options.recordFile = value;
+        } else if (flag == "--keyframes") {
+            ok = (in >> options.keyframeInterval) && options.keyframeInterval > 0;
+        } else {
+            usage("unknown option " + flag);
+        }
+        if (!ok) usage("bad value for " + flag + ": " + value);
+    }
+    if (options.hashlife && options.untilStable) {
+        usage("--until-stable needs a grid engine, not --hashlife");
+    }
+    if (options.hashlife && !options.recordFile.empty()) {
+        usage("--record needs a grid engine, not --hashlife");
+    }
+    if (options.wrap && options.hashlife) {
+        usage("--wrap needs a grid engine, not --hashlife");
+    }
+    if (options.wrap && (options.type == LifeEngine::Classic || options.type == LifeEngine::Plane)) {
+        usage("the " + LifeEngine::typeToName(options.type) + " engine can't wrap its edges");
+    }
+    bool unbounded = options.hashlife || options.type == LifeEngine::Plane;
+    if (unbounded && options.rule.bornFromNothing()) {
+        usage("an unbounded plane can't run " + options.rule.toString());
+    }
+}
+
+static void usage(const string& problem) {
+    cerr << "life-bench: " << problem << endl;
+    cerr << "usage: life-bench [--file <colony> | --random <rows>x<cols>] [--density <p>]" << endl;
+    cerr << "                  [--seed <n>] [--generations <n>] [--engine <name>]" << endl;
+    cerr << "                  [--threads <n>] [--wrap] [--rule <rule>] [--until-stable]" << endl;
+    cerr << "                  [--record <file>] [--keyframes <n>] [--hashlife]" << endl;
+    exit(1);
+}
+
+static double now() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/**
+ * ru_maxrss is in kilobytes on Linux but in bytes on Mac OS X.
+ */
+
+static long peakMemoryKB() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+static long long countLiveCells(const LifeEngine& engine) {
+    long long count = 0;
+    for (int row = 0; row < engine.numRows(); row++) {
+        for (int col = 0; col < engine.numCols(); col++) {
+            if (engine.getAge(row, col) > 0) count++;
+        }
+    }
+    return count;
+}
+
+static void loadColony(const BenchOptions& options, LifeEngine& engine) {
+    if (options.file.empty()) {
+        seedRandomColony(engine, options.numRows, options.numCols, options.density, options.seed);
+    } else if (!readColonyFile(options.file, engine)) {
+        usage("can't open colony file " + options.file);
+    }
+    if (options.ruleGiven) engine.setRule(options.rule);
+}
+
+static void runEngine(const BenchOptions& options) {
+    LifeEngine *engine = LifeEngine::createLifeEngine(options.type, options.numThreads);
+    if (options.wrap) engine->setBoundary(LifeEngine::Toroidal);
+    engine->setStateTracking(options.untilStable);
+    loadColony(options, *engine);
+    long long cells = (long long) engine->numRows() * engine->numCols();
+
+    LifeRecorder recorder;
+    bool recording = !options.recordFile.empty();
+    if (recording && !recorder.open(options.recordFile, *engine, options.keyframeInterval)) {
+        usage("can't create recording " + options.recordFile);
+    }
+    LifeCycleDetector cycles;
+    bool settled = options.untilStable && cycles.observe(*engine);
+    long long generations = 0;
+    double start = now();
+    while (!settled && generations < options.generations) {
+        engine->step();
+        if (recording) recorder.record(*engine);
+        generations++;
+        settled = options.untilStable && cycles.observe(*engine);
+    }
+    recorder.close();
+    double elapsed = now() - start;
+
+    cout << "engine:            " << LifeEngine::typeToName(options.type) << endl;
+    cout << "rule:              " << engine->getRule().toString() << endl;
+    cout << "colony:            " << engine->numRows() << " x " << engine->numCols()
+         << (options.wrap ? " (wrapped)" : "") << endl;
+    cout << "generations:       " << generations << endl;
+    if (settled) {
+        cout << "settled:           period " << cycles.getPeriod() << " from generation "
+             << cycles.getCycleStart() << endl;
+    }
+    cout << "final population:  " << countLiveCells(*engine) << endl;
+    if (recording) {
+        cout << "recorded:          " << recorder.bytesWritten() << " bytes to "
+             << options.recordFile << endl;
+    }
+    cout << "seconds:           " << elapsed << endl;
+    if (elapsed > 0) {
+        cout << "generations/sec:   " << generations / elapsed << endl;
+        cout << "cell updates/sec:  " << generations * cells / elapsed << endl;
+    }
+    delete engine;
+}
+
+/**
+ * HashLife takes its starting colony, and its rule, from a grid engine,
+ * which is the simplest way to reuse the colony loaders.
+ */
+
+static void runHashLife(const BenchOptions& options) {
+    LifeEngine *engine = LifeEngine::createLifeEngine(LifeEngine::Classic);
+    loadColony(options, *engine);
+    HashLife life;
+    for (int row = 0; row < engine->numRows(); row++) {
+        for (int col = 0; col < engine->numCols(); col++) {
+            if (engine->getAge(row, col) > 0) life.setCell(row, col, true);
+        }
+    }
+    life.setRule(engine->getRule());
+    delete engine;
+
+    double start = now();
+    life.advance(options.generations);
+    double elapsed = now() - start;
+
+    cout << "engine:            HashLife" << endl;
+    cout << "rule:              " << life.getRule().toString() << endl;
+    cout << "generations:       " << life.getGeneration() << endl;
+    cout << "final population:  " << life.population() << endl;
+    long long top, left, bottom, right;
+    if (life.boundingBox(top, left, bottom, right)) {
+        cout << "bounding box:      (" << top << ", " << left << ") to ("
+             << bottom << ", " << right << ")" << endl;
+    }
+    cout << "seconds:           " << elapsed << endl;
+    if (elapsed > 0) {
+        cout << "generations/sec:   " << options.generations / elapsed << endl;
+    }
+}
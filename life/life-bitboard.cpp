@@ -0,0 +1,328 @@
+/**
+ * File: life-bitboard.cpp
+ * -----------------------
+ * Implements the bitboard stepping engine.  The neighbour count of
+ * every cell in a word is formed by a small tree of full adders over
+ * the eight shifted neighbour words, leaving the count in four
+ * bitplanes (ones, twos, fours, eights), and the rule picks the
+ * survivors and births out of those.  When the compiler targets
+ * AVX2 the adder tree runs over four words at once; otherwise the
+ * portable 64-bit version does all of the work.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "life-bitboard.h"
+#include "life-bits.h"
+#include "life-constants.h"  // for kMaxAge
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+using namespace std;
+
+void BitboardLifeEngine::resize(int numRows, int numCols) {
+    nRows = numRows;
+    nCols = numCols;
+    generation = 0;
+    wordsPerRow = (numCols + 63) / 64;
+    int leftover = numCols % 64;
+    lastWordMask = (leftover == 0) ? ~uint64_t(0) : (uint64_t(1) << leftover) - 1;
+    stateHash = 0;
+    population = 0;
+
+    size_t planeSize = size_t(numRows + 2) * wordsPerRow;
+    live.assign(planeSize, 0);
+    nextLive.assign(planeSize, 0);
+    for (int bit = 0; bit < kAgeBits; bit++) {
+        age[bit].assign(planeSize, 0);
+    }
+    for (int slot = 0; slot < 3; slot++) {
+        westRows[slot].assign(wordsPerRow, 0);
+        eastRows[slot].assign(wordsPerRow, 0);
+    }
+}
+
+int BitboardLifeEngine::getAge(int row, int col) const {
+    checkBounds(row, col, "BitboardLifeEngine::getAge");
+    size_t index = size_t(row + 1) * wordsPerRow + col / 64;
+    int shift = col % 64;
+    int result = 0;
+    for (int bit = 0; bit < kAgeBits; bit++) {
+        result |= int((age[bit][index] >> shift) & 1) << bit;
+    }
+    return result;
+}
+
+/**
+ * Whole words with nothing alive in them are skipped, and the rest
+ * are unpacked a bitplane at a time.
+ */
+
+void BitboardLifeEngine::getRowAges(int row, unsigned char *ages) const {
+    checkBounds(row, 0, "BitboardLifeEngine::getRowAges");
+    size_t first = size_t(row + 1) * wordsPerRow;
+    for (int w = 0; w < wordsPerRow; w++) {
+        int base = 64 * w;
+        int width = min(64, nCols - base);
+        fill(ages + base, ages + base + width, 0);
+        if (live[first + w] == 0) continue;
+        for (int bit = 0; bit < kAgeBits; bit++) {
+            uint64_t plane = age[bit][first + w];
+            for (; plane != 0; plane &= plane - 1) {
+                ages[base + lowestBit(plane)] |= (unsigned char) (1 << bit);
+            }
+        }
+    }
+}
+
+void BitboardLifeEngine::getRowLiveBits(int row, unsigned char *bits) const {
+    checkBounds(row, 0, "BitboardLifeEngine::getRowLiveBits");
+    const uint64_t *words = &live[size_t(row + 1) * wordsPerRow];
+    int numBytes = (nCols + 7) / 8;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (int j = 0; j < numBytes; j++) {
+        bits[j] = (unsigned char) (words[j / 8] >> (8 * (j % 8)));
+    }
+#else
+    memcpy(bits, words, numBytes);
+#endif
+}
+
+void BitboardLifeEngine::setAge(int row, int col, int cellAge) {
+    checkBounds(row, col, "BitboardLifeEngine::setAge");
+    cellAge = min(max(cellAge, 0), kMaxAge);
+    size_t index = size_t(row + 1) * wordsPerRow + col / 64;
+    uint64_t mask = uint64_t(1) << (col % 64);
+    noteAgeChange(row, col, (live[index] & mask) != 0, cellAge);
+    if (cellAge > 0) live[index] |= mask;
+    else live[index] &= ~mask;
+    for (int bit = 0; bit < kAgeBits; bit++) {
+        if ((cellAge >> bit) & 1) age[bit][index] |= mask;
+        else age[bit][index] &= ~mask;
+    }
+}
+
+void BitboardLifeEngine::setBoundary(Boundary boundary) {
+    this->boundary = boundary;
+    if (boundary == DeadEdges && nRows > 0) {
+        fill(live.begin(), live.begin() + wordsPerRow, 0);
+        fill(live.end() - wordsPerRow, live.end(), 0);
+        fill(nextLive.begin(), nextLive.begin() + wordsPerRow, 0);
+        fill(nextLive.end() - wordsPerRow, nextLive.end(), 0);
+    }
+}
+
+void BitboardLifeEngine::setRule(const LifeRule& rule) {
+    this->rule = rule;
+    for (int k = 0; k <= 8; k++) {
+        bornWords[k] = rule.born(k) ? ~uint64_t(0) : 0;
+        survivesWords[k] = rule.survives(k) ? ~uint64_t(0) : 0;
+    }
+}
+
+void BitboardLifeEngine::step() {
+    if (nRows == 0 || nCols == 0) return;
+    if (boundary == Toroidal) {
+        copy(rowOf(live, nRows), rowOf(live, nRows) + wordsPerRow, rowOf(live, 0));
+        copy(rowOf(live, 1), rowOf(live, 1) + wordsPerRow, rowOf(live, nRows + 1));
+    }
+    shiftRow(rowOf(live, 0), &westRows[0][0], &eastRows[0][0]);
+    shiftRow(rowOf(live, 1), &westRows[1][0], &eastRows[1][0]);
+    for (int padded = 1; padded <= nRows; padded++) {
+        int above = (padded - 1) % 3;
+        int middle = padded % 3;
+        int below = (padded + 1) % 3;
+        shiftRow(rowOf(live, padded + 1), &westRows[below][0], &eastRows[below][0]);
+        computeRow(rowOf(live, padded - 1), &westRows[above][0], &eastRows[above][0],
+                   rowOf(live, padded), &westRows[middle][0], &eastRows[middle][0],
+                   rowOf(live, padded + 1), &westRows[below][0], &eastRows[below][0],
+                   rowOf(nextLive, padded));
+    }
+    ageCells();
+    live.swap(nextLive);
+    generation++;
+}
+
+uint64_t *BitboardLifeEngine::rowOf(vector<uint64_t>& plane, int paddedRow) {
+    return &plane[size_t(paddedRow) * wordsPerRow];
+}
+
+/**
+ * Produces the west and east neighbour words for every word in a row.
+ * Word w of west holds, at bit b, the cell one column to the left of
+ * column 64 * w + b, carrying the top bit in from the previous word;
+ * east is the mirror image.  Cells beyond either edge read as dead,
+ * unless the boundary is Toroidal, in which case the first and last
+ * columns are carried around to neighbour one another.
+ */
+
+void BitboardLifeEngine::shiftRow(const uint64_t *src, uint64_t *west, uint64_t *east) const {
+    for (int w = 0; w < wordsPerRow; w++) {
+        uint64_t carryIn = (w > 0) ? src[w - 1] >> 63 : 0;
+        uint64_t carryOut = (w + 1 < wordsPerRow) ? src[w + 1] << 63 : 0;
+        west[w] = (src[w] << 1) | carryIn;
+        east[w] = (src[w] >> 1) | carryOut;
+    }
+    if (boundary == Toroidal) {
+        int lastBit = (nCols - 1) % 64;
+        west[0] |= (src[wordsPerRow - 1] >> lastBit) & 1;
+        east[wordsPerRow - 1] |= (src[0] & 1) << lastBit;
+    }
+}
+
+/**
+ * The adder tree shared by the scalar and vector kernels.  Word is
+ * uint64_t or __m256i; AND, OR, XOR and ANDNOT (~a & b) are supplied
+ * as macros so the same expression serves both.  Leaves the low bit of
+ * every cell's neighbour count in ones, and the rest still split over
+ * the carries onesCarry, twosPartial and foursPartial.
+ */
+
+#define LIFE_ADDER_TREE(Word, AND, OR, XOR, ANDNOT)                           \
+    Word aboveSum = XOR(XOR(aw, a), ae);                                      \
+    Word aboveCarry = OR(AND(aw, a), AND(ae, XOR(aw, a)));                    \
+    Word middleSum = XOR(mw, me);                                             \
+    Word middleCarry = AND(mw, me);                                           \
+    Word belowSum = XOR(XOR(bw, b), be);                                      \
+    Word belowCarry = OR(AND(bw, b), AND(be, XOR(bw, b)));                    \
+    Word ones = XOR(XOR(aboveSum, middleSum), belowSum);                      \
+    Word onesCarry = OR(AND(aboveSum, middleSum), AND(belowSum, XOR(aboveSum, middleSum))); \
+    Word twosPartial = XOR(XOR(aboveCarry, middleCarry), belowCarry);         \
+    Word foursPartial = OR(AND(aboveCarry, middleCarry),                      \
+                           AND(belowCarry, XOR(aboveCarry, middleCarry)));
+
+/**
+ * Finishes the tree for Conway's rule, which only has to tell counts
+ * of two and three apart from everything else: alive with exactly
+ * three neighbours, or alive already with exactly two.
+ */
+
+#define LIFE_CONWAY_RULE(Word, AND, OR, XOR, ANDNOT)                          \
+    Word twos = XOR(twosPartial, onesCarry);                                  \
+    Word foursOrMore = OR(foursPartial, AND(twosPartial, onesCarry));         \
+    Word next = ANDNOT(foursOrMore, AND(twos, OR(ones, m)));
+
+/**
+ * Finishes the tree for any other rule.  The count is completed into
+ * four bitplanes, a mask picks out the cells with each count from 0 to
+ * 8, and those masks are ORed together for the counts the rule lists.
+ * BORN(k) and SURVIVES(k) are all ones if the rule lists k and all
+ * zeros otherwise, and ALL is all ones.
+ */
+
+#define LIFE_GENERAL_RULE(Word, AND, OR, XOR, ANDNOT, ALL, BORN, SURVIVES)    \
+    Word twos = XOR(twosPartial, onesCarry);                                  \
+    Word twosCarry = AND(twosPartial, onesCarry);                             \
+    Word fours = XOR(foursPartial, twosCarry);                                \
+    Word eights = AND(foursPartial, twosCarry);                               \
+    Word lowBits[4] = { ANDNOT(OR(ones, twos), ALL), ANDNOT(twos, ones),      \
+                        ANDNOT(ones, twos), AND(ones, twos) };                \
+    Word under4 = ANDNOT(OR(fours, eights), ALL);                             \
+    Word births = AND(eights, BORN(8));                                       \
+    Word survivors = AND(eights, SURVIVES(8));                                \
+    for (int k = 0; k < 8; k++) {                                             \
+        Word exactly = AND(lowBits[k & 3], (k < 4) ? under4 : fours);         \
+        births = OR(births, AND(exactly, BORN(k)));                           \
+        survivors = OR(survivors, AND(exactly, SURVIVES(k)));                 \
+    }                                                                         \
+    Word next = OR(ANDNOT(m, births), AND(m, survivors));
+
+#define SCALAR_AND(x, y) ((x) & (y))
+#define SCALAR_OR(x, y) ((x) | (y))
+#define SCALAR_XOR(x, y) ((x) ^ (y))
+#define SCALAR_ANDNOT(x, y) (~(x) & (y))
+
+void BitboardLifeEngine::computeRow(const uint64_t *above, const uint64_t *westAbove, const uint64_t *eastAbove,
+                                    const uint64_t *middle, const uint64_t *westMiddle, const uint64_t *eastMiddle,
+                                    const uint64_t *below, const uint64_t *westBelow, const uint64_t *eastBelow,
+                                    uint64_t *result) const {
+    bool conway = rule.isConway();
+    int w = 0;
+#if defined(__AVX2__)
+    __m256i bornVectors[9], survivesVectors[9];
+    for (int k = 0; k <= 8; k++) {
+        bornVectors[k] = _mm256_set1_epi64x((long long) bornWords[k]);
+        survivesVectors[k] = _mm256_set1_epi64x((long long) survivesWords[k]);
+    }
+#define VECTOR_ALL _mm256_set1_epi64x(-1)
+#define VECTOR_BORN(k) bornVectors[k]
+#define VECTOR_SURVIVES(k) survivesVectors[k]
+    for (; w + 4 <= wordsPerRow; w += 4) {
+#define LOAD(p) _mm256_loadu_si256((const __m256i *) ((p) + w))
+        __m256i aw = LOAD(westAbove), a = LOAD(above), ae = LOAD(eastAbove);
+        __m256i mw = LOAD(westMiddle), m = LOAD(middle), me = LOAD(eastMiddle);
+        __m256i bw = LOAD(westBelow), b = LOAD(below), be = LOAD(eastBelow);
+#undef LOAD
+        LIFE_ADDER_TREE(__m256i, _mm256_and_si256, _mm256_or_si256, _mm256_xor_si256, _mm256_andnot_si256)
+        if (conway) {
+            LIFE_CONWAY_RULE(__m256i, _mm256_and_si256, _mm256_or_si256, _mm256_xor_si256,
+                             _mm256_andnot_si256)
+            _mm256_storeu_si256((__m256i *) (result + w), next);
+        } else {
+            LIFE_GENERAL_RULE(__m256i, _mm256_and_si256, _mm256_or_si256, _mm256_xor_si256,
+                              _mm256_andnot_si256, VECTOR_ALL, VECTOR_BORN, VECTOR_SURVIVES)
+            _mm256_storeu_si256((__m256i *) (result + w), next);
+        }
+    }
+#endif
+#define SCALAR_ALL (~uint64_t(0))
+#define SCALAR_BORN(k) bornWords[k]
+#define SCALAR_SURVIVES(k) survivesWords[k]
+    for (; w < wordsPerRow; w++) {
+        uint64_t aw = westAbove[w], a = above[w], ae = eastAbove[w];
+        uint64_t mw = westMiddle[w], m = middle[w], me = eastMiddle[w];
+        uint64_t bw = westBelow[w], b = below[w], be = eastBelow[w];
+        LIFE_ADDER_TREE(uint64_t, SCALAR_AND, SCALAR_OR, SCALAR_XOR, SCALAR_ANDNOT)
+        if (conway) {
+            LIFE_CONWAY_RULE(uint64_t, SCALAR_AND, SCALAR_OR, SCALAR_XOR, SCALAR_ANDNOT)
+            result[w] = next;
+        } else {
+            LIFE_GENERAL_RULE(uint64_t, SCALAR_AND, SCALAR_OR, SCALAR_XOR, SCALAR_ANDNOT,
+                              SCALAR_ALL, SCALAR_BORN, SCALAR_SURVIVES)
+            result[w] = next;
+        }
+    }
+    result[wordsPerRow - 1] &= lastWordMask;
+}
+
+/**
+ * Brings the age bitplanes in line with nextLive.  Survivors below
+ * kMaxAge get a bit-sliced increment (a ripple carry through the four
+ * planes), newborns get age 1, and everything dead is cleared to 0.
+ * Words with a birth or death in them also update the state hash and
+ * population, one changed cell at a time.
+ */
+
+void BitboardLifeEngine::ageCells() {
+    unsigned long long hash = 0;
+    long long births = 0;
+    long long deaths = 0;
+    for (size_t i = wordsPerRow; i < size_t(nRows + 1) * wordsPerRow; i++) {
+        uint64_t before = live[i];
+        uint64_t after = nextLive[i];
+        uint64_t atMax = ~uint64_t(0);
+        for (int bit = 0; bit < kAgeBits; bit++) {
+            atMax &= ((kMaxAge >> bit) & 1) ? age[bit][i] : ~age[bit][i];
+        }
+        uint64_t carry = before & after & ~atMax;
+        for (int bit = 0; bit < kAgeBits; bit++) {
+            uint64_t plane = age[bit][i];
+            age[bit][i] = (plane ^ carry) & after;
+            carry &= plane;
+        }
+        age[0][i] |= after & ~before;
+
+        uint64_t flips = before ^ after;
+        if (flips != 0 && tracking) {
+            long long row = (long long) (i / wordsPerRow) - 1;
+            long long colBase = (long long) (i % wordsPerRow) * 64;
+            births += countBits(after & flips);
+            deaths += countBits(before & flips);
+            for (; flips != 0; flips &= flips - 1) {
+                hash ^= cellKey(row, colBase + lowestBit(flips));
+            }
+        }
+    }
+    stateHash ^= hash;
+    population += births - deaths;
+}
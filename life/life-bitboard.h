@@ -0,0 +1,77 @@
+/**
+ * File: life-bitboard.h
+ * ---------------------
+ * Defines a stepping engine that packs 64 cells into each machine word
+ * and computes all 64 neighbour counts at once with bit-parallel adders.
+ * Cell ages are bit-sliced as well: four extra bitplanes hold the
+ * binary digits of every cell's age, so aging is just a few more
+ * logical operations per word rather than a pass over every cell.
+ */
+
+#ifndef _life_bitboard_h_
+#define _life_bitboard_h_
+
+#include <vector>
+#include <stdint.h>
+#include "life-engine.h"
+
+class BitboardLifeEngine : public LifeEngine {
+public:
+    virtual void resize(int numRows, int numCols);
+    virtual int getAge(int row, int col) const;
+    virtual void getRowAges(int row, unsigned char *ages) const;
+    virtual void getRowLiveBits(int row, unsigned char *bits) const;
+    virtual void setAge(int row, int col, int age);
+    virtual void setBoundary(Boundary boundary);
+    virtual void setRule(const LifeRule& rule);
+    virtual void step();
+
+private:
+
+/**
+ * Each row occupies wordsPerRow consecutive words, with bit b of word
+ * w holding column 64 * w + b.  Row r of the colony lives at row r + 1
+ * of every plane; rows 0 and nRows + 1 are permanently dead padding,
+ * so the kernel never has to special-case the top and bottom edges.
+ * Under Toroidal those two rows are refreshed with copies of the last
+ * and first rows before each step, and shiftRow carries the edge
+ * columns around to the opposite side.
+ */
+
+    static const int kAgeBits = 4;
+
+    int wordsPerRow;
+    uint64_t lastWordMask;
+    std::vector<uint64_t> live;
+    std::vector<uint64_t> nextLive;
+    std::vector<uint64_t> age[kAgeBits];
+
+/**
+ * The rule spelled out a count at a time, as words that are all ones
+ * if a cell with that many neighbours is born (or survives) and all
+ * zeros if not.  Only consulted for rules other than Conway's, which
+ * has a kernel of its own.
+ */
+
+    uint64_t bornWords[9];
+    uint64_t survivesWords[9];
+
+/**
+ * Scratch rows holding the west- and east-shifted copies of the three
+ * rows under the kernel.  They're rotated rather than recomputed as
+ * the kernel walks down the colony.
+ */
+
+    std::vector<uint64_t> westRows[3];
+    std::vector<uint64_t> eastRows[3];
+
+    uint64_t *rowOf(std::vector<uint64_t>& plane, int paddedRow);
+    void shiftRow(const uint64_t *src, uint64_t *west, uint64_t *east) const;
+    void computeRow(const uint64_t *above, const uint64_t *westAbove, const uint64_t *eastAbove,
+                    const uint64_t *middle, const uint64_t *westMiddle, const uint64_t *eastMiddle,
+                    const uint64_t *below, const uint64_t *westBelow, const uint64_t *eastBelow,
+                    uint64_t *result) const;
+    void ageCells();
+};
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * File: life-bits.h
+ * -----------------
+ * A few bit-twiddling helpers shared by the engines that pick the
+ * births and deaths out of a generation a word at a time.
+ */
+
+#ifndef _life_bits_h_
+#define _life_bits_h_
+
+#include <cstring>
+#include <stdint.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Returns the number of set bits in word.
+ */
+
+inline int countBits(uint64_t word) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    for (; word != 0; word &= word - 1) count++;
+    return count;
+#endif
+}
+
+/**
+ * Returns the index of the lowest set bit in word, which must not be 0.
+ */
+
+inline int lowestBit(uint64_t word) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (((word >> bit) & 1) == 0) bit++;
+    return bit;
+#endif
+}
+
+/**
+ * Reads the eight bytes at p, which needn't be aligned, and returns a
+ * word with the top bit of each byte set if that byte is nonzero and
+ * every other bit clear.  XORing the results for two generations
+ * picks out the cells that were born or died, without looking at the
+ * cells one at a time.
+ */
+
+inline uint64_t nonzeroBytes(const unsigned char *p) {
+    uint64_t word;
+    memcpy(&word, p, sizeof word);
+    const uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+    return (((word & low7) + low7) | word) & ~low7;
+}
+
+/**
+ * Returns which of the eight bytes read by nonzeroBytes is reported
+ * in the given bit, which depends on the machine's byte order.
+ */
+
+inline int byteOfBit(int bit) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return 7 - bit / 8;
+#else
+    return bit / 8;
+#endif
+}
+
+/**
+ * Packs the eight bytes at p into a single byte, with bit k set if
+ * byte k is nonzero.
+ */
+
+inline unsigned char packNonzeroBytes(const unsigned char *p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    unsigned char packed = 0;
+    for (int k = 0; k < 8; k++) packed |= (unsigned char) ((p[k] != 0) << k);
+    return packed;
+#else
+    return (unsigned char) (((nonzeroBytes(p) >> 7) * 0x0102040810204080ULL) >> 56);
+#endif
+}
+
+/**
+ * Packs count bytes into (count + 7) / 8 bytes of bits, with bit k of
+ * bits[j] set if bytes[8 * j + k] is nonzero.  With SSE2, which every
+ * x86-64 processor has, sixteen bytes are compared with 0 and packed
+ * by a single movemask.
+ */
+
+inline void packNonzero(const unsigned char *bytes, int count, unsigned char *bits) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *) (bytes + i));
+        int live = ~_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero));
+        bits[i / 8] = (unsigned char) live;
+        bits[i / 8 + 1] = (unsigned char) (live >> 8);
+    }
+#endif
+    for (; i + 8 <= count; i += 8) {
+        bits[i / 8] = packNonzeroBytes(bytes + i);
+    }
+    if (i < count) {
+        unsigned char last = 0;
+        for (int k = 0; i + k < count; k++) last |= (unsigned char) ((bytes[i + k] != 0) << k);
+        bits[i / 8] = last;
+    }
+}
+
+#endif
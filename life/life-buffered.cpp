@@ -0,0 +1,150 @@
+/**
+ * File: life-buffered.cpp
+ * -----------------------
+ * Implements the double-buffered stepping engine.
+ */
+
+#include <algorithm>
+#include "life-buffered.h"
+#include "life-constants.h"  // for kMaxAge
+#include "life-kernel.h"
+#include "life-bits.h"
+using namespace std;
+
+DoubleBufferedLifeEngine::DoubleBufferedLifeEngine() {
+    current = NULL;
+    next = NULL;
+    stride = 0;
+}
+
+void DoubleBufferedLifeEngine::resize(int numRows, int numCols) {
+    stride = numCols + 2;
+    buffers[0].assign(size_t(numRows + 2) * stride, 0);
+    buffers[1].assign(size_t(numRows + 2) * stride, 0);
+    current = &buffers[0][0];
+    next = &buffers[1][0];
+    nRows = numRows;
+    nCols = numCols;
+    generation = 0;
+    stateHash = 0;
+    population = 0;
+}
+
+int DoubleBufferedLifeEngine::getAge(int row, int col) const {
+    checkBounds(row, col, "DoubleBufferedLifeEngine::getAge");
+    return current[size_t(row + 1) * stride + col + 1];
+}
+
+void DoubleBufferedLifeEngine::getRowAges(int row, unsigned char *ages) const {
+    checkBounds(row, 0, "DoubleBufferedLifeEngine::getRowAges");
+    const unsigned char *cells = current + size_t(row + 1) * stride + 1;
+    copy(cells, cells + nCols, ages);
+}
+
+void DoubleBufferedLifeEngine::getRowLiveBits(int row, unsigned char *bits) const {
+    checkBounds(row, 0, "DoubleBufferedLifeEngine::getRowLiveBits");
+    packNonzero(current + size_t(row + 1) * stride + 1, nCols, bits);
+}
+
+void DoubleBufferedLifeEngine::setAge(int row, int col, int age) {
+    checkBounds(row, col, "DoubleBufferedLifeEngine::setAge");
+    unsigned char& cell = current[size_t(row + 1) * stride + col + 1];
+    age = min(max(age, 0), kMaxAge);
+    noteAgeChange(row, col, cell, age);
+    cell = (unsigned char) age;
+}
+
+/**
+ * Before the first resize there are no buffers to clear, and resize
+ * starts them with a dead border anyway.
+ */
+
+void DoubleBufferedLifeEngine::setBoundary(Boundary boundary) {
+    this->boundary = boundary;
+    if (boundary == DeadEdges && !buffers[0].empty()) {
+        for (int i = 0; i < 2; i++) {
+            unsigned char *buffer = &buffers[i][0];
+            fill(buffer, buffer + stride, 0);
+            fill(buffer + size_t(nRows + 1) * stride, buffer + size_t(nRows + 2) * stride, 0);
+            for (int x = 1; x <= nRows; x++) {
+                buffer[size_t(x) * stride] = 0;
+                buffer[size_t(x) * stride + nCols + 1] = 0;
+            }
+        }
+    }
+}
+
+void DoubleBufferedLifeEngine::step() {
+    fillBorder();
+    StepTally tally;
+    stepRows(0, nRows, tally);
+    swapBuffers(tally);
+}
+
+void DoubleBufferedLifeEngine::stepRows(int startRow, int endRow, StepTally& tally) {
+    stepRegion(startRow, endRow, 0, nCols, tally);
+}
+
+/**
+ * Thanks to the dead border, every cell has all eight neighbours in
+ * memory, so each row is a single call to the branch-free kernel in
+ * life-kernel.h.  Births and deaths are tallied afterwards, in a
+ * separate pass over each row, to keep that loop free of them.
+ */
+
+bool DoubleBufferedLifeEngine::stepRegion(int startRow, int endRow, int startCol, int endCol,
+                                          StepTally& tally) {
+    unsigned char differences = 0;
+    unsigned char alive = 0;
+    for (int x = startRow; x < endRow; x++) {
+        const unsigned char *above = current + size_t(x) * stride + 1 + startCol;
+        const unsigned char *here = above + stride;
+        const unsigned char *below = here + stride;
+        unsigned char *to = next + size_t(x + 1) * stride + 1 + startCol;
+        stepCellRow(rule, above, here, below, to, endCol - startCol, differences, alive);
+        if (tracking) tallyRow(x, startCol, here, to, endCol - startCol, tally);
+    }
+    return differences != 0;
+}
+
+/**
+ * The window for row x covers rows x - 1 through x + 1, which in the
+ * bordered buffer are rows x through x + 2, so moving it down a row
+ * adds buffer row x + 2 and drops buffer row x - 1.  The sums cover one
+ * column either side of the strip, which the border always provides.
+ */
+
+void DoubleBufferedLifeEngine::stepStrip(int startCol, int endCol, unsigned char *columnSums,
+                                         StepTally& tally) {
+    if (nRows == 0) return;
+    int width = endCol - startCol;
+    const unsigned char *column = current + startCol;  // column startCol - 1 of buffer row 0
+    startColumnSums(column, column + stride, column + 2 * size_t(stride), columnSums, width + 2);
+    for (int x = 0; x < nRows; x++) {
+        if (x > 0) {
+            slideColumnSums(column + size_t(x + 2) * stride, column + size_t(x - 1) * stride,
+                            columnSums, width + 2);
+        }
+        const unsigned char *here = column + size_t(x + 1) * stride + 1;
+        unsigned char *to = next + size_t(x + 1) * stride + 1 + startCol;
+        stepWindowRow(rule, columnSums + 1, here, to, width);
+        if (tracking) tallyRow(x, startCol, here, to, width, tally);
+    }
+}
+
+void DoubleBufferedLifeEngine::fillBorder() {
+    if (boundary != Toroidal) return;
+    for (int x = 1; x <= nRows; x++) {
+        unsigned char *row = current + size_t(x) * stride;
+        row[0] = row[nCols];
+        row[nCols + 1] = row[1];
+    }
+    copy(current + size_t(nRows) * stride, current + size_t(nRows + 1) * stride, current);
+    copy(current + stride, current + 2 * size_t(stride), current + size_t(nRows + 1) * stride);
+}
+
+void DoubleBufferedLifeEngine::swapBuffers(const StepTally& tally) {
+    swap(current, next);
+    generation++;
+    applyTally(tally);
+}
@@ -0,0 +1,95 @@
+/**
+ * File: life-buffered.h
+ * ---------------------
+ * Defines a stepping engine that keeps two generations in preallocated
+ * buffers and ping-pongs between them.  Each generation is computed in a
+ * single pass from the current buffer straight into the other one, and
+ * then the two swap roles by pointer, so stepping never allocates and
+ * never copies a buffer.
+ *
+ * Ages never exceed kMaxAge, so each cell is stored in a single byte
+ * rather than an int, a quarter of the memory a Grid<int> needs.
+ * Both the DeadEdges and Toroidal boundaries are supported.
+ */
+
+#ifndef _life_buffered_h_
+#define _life_buffered_h_
+
+#include <vector>
+#include "life-engine.h"
+
+class DoubleBufferedLifeEngine : public LifeEngine {
+public:
+    DoubleBufferedLifeEngine();
+
+    virtual void resize(int numRows, int numCols);
+    virtual int getAge(int row, int col) const;
+    virtual void getRowAges(int row, unsigned char *ages) const;
+    virtual void getRowLiveBits(int row, unsigned char *bits) const;
+    virtual void setAge(int row, int col, int age);
+    virtual void setBoundary(Boundary boundary);
+    virtual void step();
+
+protected:
+
+/**
+ * Brings the border of the current buffer up to date before a step.
+ * Under Toroidal, the border holds copies of the cells on the opposite
+ * edge, so the stepping kernel wraps around without a single extra
+ * branch or modulus.  Under DeadEdges the border is always zero and
+ * this does nothing.
+ */
+
+    void fillBorder();
+
+/**
+ * Computes rows [startRow, endRow) of the next generation from the
+ * current one, adding their births and deaths to tally.  Rows only
+ * ever read from current and write to next, so disjoint row ranges
+ * can be computed in any order.
+ */
+
+    void stepRows(int startRow, int endRow, StepTally& tally);
+
+/**
+ * Computes the rectangle of rows [startRow, endRow) and columns
+ * [startCol, endCol) of the next generation, adding its births and
+ * deaths to tally, and returns true if any cell in it differs from
+ * the current generation.
+ */
+
+    bool stepRegion(int startRow, int endRow, int startCol, int endCol, StepTally& tally);
+
+/**
+ * Computes columns [startCol, endCol) of every row of the next
+ * generation, adding their births and deaths to tally, by sliding a
+ * window of column sums down the strip, so that each row is read from
+ * the current generation once.  columnSums is scratch space for
+ * endCol - startCol + 2 sums.
+ */
+
+    void stepStrip(int startCol, int endCol, unsigned char *columnSums, StepTally& tally);
+
+/**
+ * Makes the freshly computed generation the current one, folding the
+ * tally of its births and deaths into stateHash and population.
+ */
+
+    void swapBuffers(const StepTally& tally);
+
+private:
+
+/**
+ * Each buffer is the colony surrounded by a one-cell border of dead
+ * cells, stored row by row, so that the neighbours of every real cell
+ * can be read without any bounds checks at all.  Cell (row, col) lives
+ * at index (row + 1) * stride + col + 1, where stride is nCols + 2.
+ */
+
+    std::vector<unsigned char> buffers[2];
+    unsigned char *current;
+    unsigned char *next;
+    int stride;
+};
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ * File: life-classic.cpp
+ * ----------------------
+ * Implements the original Grid<int> stepping engine.  The two
+ * helpers are the cellFlagger and lifeGenerator routines that used
+ * to live in life.cpp, changed only to take the rule as a LifeRule
+ * rather than hard-coding Conway's.
+ */
+
+#include <algorithm>
+#include "life-classic.h"
+#include "life-constants.h"  // for kMaxAge
+using namespace std;
+
+void ClassicLifeEngine::resize(int numRows, int numCols) {
+    thisgeneration.resize(numRows, numCols);
+    nRows = numRows;
+    nCols = numCols;
+    generation = 0;
+    stateHash = 0;
+    population = 0;
+}
+
+int ClassicLifeEngine::getAge(int row, int col) const {
+    checkBounds(row, col, "ClassicLifeEngine::getAge");
+    return thisgeneration.get(row, col);
+}
+
+void ClassicLifeEngine::setAge(int row, int col, int age) {
+    checkBounds(row, col, "ClassicLifeEngine::setAge");
+    age = min(max(age, 0), kMaxAge);
+    noteAgeChange(row, col, thisgeneration.get(row, col), age);
+    thisgeneration.set(row, col, age);
+}
+
+void ClassicLifeEngine::step() {
+    Grid<int> birthsanddeaths(nRows, nCols);
+    Grid<int> nextgeneration(nRows, nCols);
+    nextgeneration = thisgeneration;
+    cellFlagger(rule, nextgeneration, birthsanddeaths);
+    lifeGenerator(nextgeneration, birthsanddeaths);
+    for (int x = 0; tracking && x < nRows; x++) {
+        for (int y = 0; y < nCols; y++) {
+            noteAgeChange(x, y, thisgeneration.get(x, y), nextgeneration.get(x, y));
+        }
+    }
+    thisgeneration = nextgeneration;
+    generation++;
+}
+
+void ClassicLifeEngine::cellFlagger(const LifeRule& rule, Grid<int>& nextgeneration, Grid<int>& birthsanddeaths) {
+    int count;
+    int nrows = nextgeneration.numRows();
+    int ncols = nextgeneration.numCols();
+    for (int x = 0; x < nrows; x++) {
+        for (int y = 0; y < ncols; y++) {// counts through the cells around the cell
+                count = 0;
+                if (nextgeneration.inBounds(x + 1, y) == true) {
+                    int check = nextgeneration[x + 1][y];
+                    if (check >= 1) {
+                        count++;
+                    }
+                }
+                if (nextgeneration.inBounds(x - 1, y) == true) {
+                    int check = nextgeneration[x - 1][y];
+                    if (check >= 1) {
+                        count++;
+                    }
+                }
+                if (nextgeneration.inBounds(x, y + 1) == true) {
+                    int check = nextgeneration[x][y + 1];
+                    if (check >= 1) {
+                        count++;
+                    }
+                }
+                if (nextgeneration.inBounds(x, y - 1) == true) {
+                    int check = nextgeneration[x][y - 1];
+                    if (check >= 1) {
+                        count++;
+                    }
+                }
+                if (nextgeneration.inBounds(x - 1, y - 1) == true) {
+                    int check = nextgeneration[x - 1][y - 1];
+                    if (check >= 1) {
+                        count++;
+                    }
+                }
+                if (nextgeneration.inBounds(x + 1, y - 1) == true) {
+                    int check = nextgeneration[x + 1][y - 1];
+                    if (check >= 1) {
+                        count++;
+                    }
+                }
+                if (nextgeneration.inBounds(x + 1, y + 1) == true) {
+                    int check = nextgeneration[x + 1][y + 1];
+                    if (check >= 1) {
+                        count++;
+                    }
+                }
+                if (nextgeneration.inBounds(x - 1, y + 1) == true) {
+                    int check = nextgeneration[x - 1][y + 1];
+                    if (check >= 1) {
+                        count++;
+                    }
+                }
+            if (!rule.survives(count)) {// marks cells for death
+                birthsanddeaths.set(x, y, -3);
+            }
+            if (rule.born(count) && nextgeneration[x][y] == 0) {// marks squares for new cells
+                birthsanddeaths.set(x, y, 3);
+                }
+          }
+    }
+}
+
+void ClassicLifeEngine::lifeGenerator(Grid<int>& nextgeneration, Grid<int>& birthsanddeaths) {
+    int nrows = nextgeneration.numRows();
+    int ncols = nextgeneration.numCols();
+    for (int turn = 1; turn < 4; turn++) {
+        for (int x = 0; x < nrows; x++) {
+            for (int y = 0; y < ncols; y++) {
+                if (turn == 1) {// deletes the cells that are marked by cellflagger to die
+                    int dead = birthsanddeaths.get(x, y);
+                    if (dead == -3) {
+                        nextgeneration.set(x, y, 0);
+                    }
+                }
+                else if (turn == 2) {// processes the age of the ones that remain
+                    int live = nextgeneration.get(x, y);
+                    if (live > 0 && live < kMaxAge) {
+                        live++;
+                        nextgeneration.set(x, y, live);
+                    }
+                }
+                else if (turn == 3) {// creates new cells on squares marked by cellflagger
+                    int born = birthsanddeaths.get(x, y);
+                    if (born == 3) { if (nextgeneration[x][y] == 0) {
+                        nextgeneration.set(x, y, 1);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
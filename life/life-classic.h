@@ -0,0 +1,30 @@
+/**
+ * File: life-classic.h
+ * --------------------
+ * Defines the original Grid<int> stepping engine.  Each generation is
+ * computed by flagging births and deaths into a scratch grid and then
+ * applying them in three passes.  It's slow, but it's the reference
+ * implementation against which all of the faster engines are checked.
+ */
+
+#ifndef _life_classic_h_
+#define _life_classic_h_
+
+#include "grid.h"
+#include "life-engine.h"
+
+class ClassicLifeEngine : public LifeEngine {
+public:
+    virtual void resize(int numRows, int numCols);
+    virtual int getAge(int row, int col) const;
+    virtual void setAge(int row, int col, int age);
+    virtual void step();
+
+private:
+    Grid<int> thisgeneration;
+
+    static void cellFlagger(const LifeRule& rule, Grid<int>& nextgeneration, Grid<int>& birthsanddeaths);
+    static void lifeGenerator(Grid<int>& nextgeneration, Grid<int>& birthsanddeaths);
+};
+
+#endif
@@ -0,0 +1,227 @@
+/**
+ * File: life-colony.cpp
+ * ---------------------
+ * Implements the colony loading and seeding routines.
+ */
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <algorithm>
+#include "life-colony.h"
+#include "life-constants.h"  // for kMaxAge
+#include "error.h"
+#include "strlib.h"
+using namespace std;
+
+/**
+ * Cells read from a colony file don't come with an age, so they all
+ * start out partway through their lives.
+ */
+
+static const int kColonyFileAge = 5;
+
+static bool nextContentLine(istream& inp, string& line);
+static bool isCountLine(const string& line);
+static bool isRLEHeader(const string& line);
+static void readPlainText(ifstream& inp, string line, LifeEngine& engine);
+static void readRLE(istream& inp, const string& header, LifeEngine& engine,
+                    const string& filename);
+static unsigned long long nextRandom(unsigned long long& state);
+
+/**
+ * The first line that isn't a comment decides the format: an RLE file
+ * always starts with its "x = ..." header.
+ */
+
+bool readColonyFile(const string& filename, LifeEngine& engine) {
+    ifstream inp(filename.c_str());
+    if (!inp.is_open()) return false;
+
+    string line;
+    if (!nextContentLine(inp, line)) {
+        engine.resize(0, 0);
+    } else if (isRLEHeader(line)) {
+        readRLE(inp, line, engine, filename);
+    } else {
+        readPlainText(inp, line, engine);
+    }
+    return true;
+}
+
+void seedRandomColony(LifeEngine& engine, int numRows, int numCols,
+                      double density, unsigned long long seed) {
+    engine.resize(numRows, numCols);
+    unsigned long long state = seed;
+    for (int x = 0; x < numRows; x++) {
+        for (int y = 0; y < numCols; y++) {
+            double chance = (nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+            if (chance < density) {
+                engine.setAge(x, y, 1 + int(nextRandom(state) % kMaxAge));
+            }
+        }
+    }
+}
+
+/**
+ * Reads the next line that isn't blank or a comment, with any carriage
+ * return left by a DOS line ending removed.  Returns false at the end
+ * of the file.
+ */
+
+static bool nextContentLine(istream& inp, string& line) {
+    while (getline(inp, line)) {
+        if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+        if (!line.empty() && line[0] != '#') return true;
+    }
+    return false;
+}
+
+static bool isCountLine(const string& line) {
+    return line.find_first_not_of("0123456789 \t") == string::npos;
+}
+
+static bool isRLEHeader(const string& line) {
+    size_t pos = line.find_first_not_of(" \t");
+    if (pos == string::npos || line[pos] != 'x') return false;
+    pos = line.find_first_not_of(" \t", pos + 1);
+    return pos != string::npos && line[pos] == '=';
+}
+
+/**
+ * The row and column counts at the top of a colony file give the size
+ * up front, so every row goes straight into the engine as it's read.
+ * A file without them is measured in a first pass and then reread.
+ */
+
+static void readPlainText(ifstream& inp, string line, LifeEngine& engine) {
+    int counts[2];
+    int numCounts = 0;
+    bool more = true;
+    while (more && numCounts < 2 && isCountLine(line)) {
+        counts[numCounts++] = atoi(line.c_str());
+        more = nextContentLine(inp, line);
+    }
+    if (numCounts < 2) {
+        counts[0] = 0;
+        counts[1] = 0;
+        for (bool measuring = more; measuring; measuring = nextContentLine(inp, line)) {
+            if (isCountLine(line)) continue;
+            counts[0]++;
+            counts[1] = max(counts[1], int(line.size()));
+        }
+        inp.clear();
+        inp.seekg(0);
+        while ((more = nextContentLine(inp, line)) && isCountLine(line)) { }
+    }
+
+    int nrows = counts[0];
+    int ncols = counts[1];
+    engine.resize(nrows, ncols);
+    for (int x = 0; more && x < nrows; x++) {
+        int width = min(int(line.size()), ncols);
+        for (int y = 0; y < width; y++) {
+            if (line[y] == 'X') engine.setAge(x, y, kColonyFileAge);
+        }
+        more = nextContentLine(inp, line);
+    }
+}
+
+/**
+ * Parses the "x = <cols>, y = <rows>" header, resizes the engine, and
+ * then decodes the body a line at a time.  Runs of dead cells are just
+ * skipped over, so only the live cells cost anything.  Any letter other
+ * than 'b' counts as alive, which covers the multi-state variants of
+ * the format, and cells outside the declared box are dropped.  A rule
+ * in the header is handed to the engine, while a header without one
+ * leaves the engine's rule alone.
+ */
+
+static void readRLE(istream& inp, const string& header, LifeEngine& engine,
+                    const string& filename) {
+    int nrows = -1;
+    int ncols = -1;
+    string ruleText;
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t comma = header.find(',', pos);
+        if (comma == string::npos) comma = header.size();
+        string field = header.substr(pos, comma - pos);
+        size_t equals = field.find('=');
+        if (equals != string::npos) {
+            string key = trim(field.substr(0, equals));
+            if (key == "x") ncols = atoi(field.c_str() + equals + 1);
+            if (key == "y") nrows = atoi(field.c_str() + equals + 1);
+            if (key == "rule") ruleText = trim(field.substr(equals + 1));
+        }
+        pos = comma + 1;
+    }
+    if (nrows < 0 || ncols < 0) {
+        error("readColonyFile: " + filename + " has no pattern size in its RLE header.");
+    }
+    if (!ruleText.empty()) {
+        LifeRule rule;
+        if (!LifeRule::parse(ruleText.substr(0, ruleText.find(':')), rule)) {
+            error("readColonyFile: " + filename + " asks for rule " + ruleText
+                  + ", which isn't a B/S rule.");
+        }
+        engine.setRule(rule);
+    }
+    engine.resize(nrows, ncols);
+
+    // No run can be longer than the pattern is wide or tall, and the
+    // position stops at the pattern's edge, so nothing here overflows.
+    int limit = max(nrows, ncols);
+    int x = 0;
+    int y = 0;
+    int count = 0;
+    string line;
+    while (getline(inp, line)) {
+        if (!line.empty() && line[0] == '#') continue;
+        for (size_t i = 0; i < line.size(); i++) {
+            char ch = line[i];
+            if (isdigit((unsigned char) ch)) {
+                int digit = ch - '0';
+                if (count > (limit - digit) / 10) {
+                    error("readColonyFile: " + filename + " has a run longer than its "
+                          + "pattern is wide or tall.");
+                }
+                count = 10 * count + digit;
+                continue;
+            }
+            int run = (count == 0) ? 1 : count;
+            count = 0;
+            if (ch == 'b' || ch == '.') {
+                y += min(run, ncols - y);
+            } else if (isalpha((unsigned char) ch)) {
+                if (x < nrows) {
+                    int end = min(y + run, ncols);
+                    for (int col = y; col < end; col++) {
+                        engine.setAge(x, col, kColonyFileAge);
+                    }
+                }
+                y += min(run, ncols - y);
+            } else if (ch == '$') {
+                x += min(run, nrows - x);
+                y = 0;
+            } else if (ch == '!') {
+                return;
+            } else if (!isspace((unsigned char) ch)) {
+                error("readColonyFile: " + filename + " has an unexpected '" + string(1, ch)
+                      + "' in its RLE pattern.");
+            }
+        }
+    }
+}
+
+/**
+ * SplitMix64: a tiny, fast generator whose whole state is one word,
+ * so every colony can carry its own.
+ */
+
+static unsigned long long nextRandom(unsigned long long& state) {
+    unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
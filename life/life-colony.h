@@ -0,0 +1,55 @@
+/**
+ * File: life-colony.h
+ * -------------------
+ * Exports the routines that fill a LifeEngine with a starting colony,
+ * either from a pattern file or from a seeded random number generator.
+ * Neither touches the display, so both serve the interactive program
+ * and the headless benchmark alike.
+ */
+
+#ifndef _life_colony_h_
+#define _life_colony_h_
+
+#include <string>
+#include "life-engine.h"
+
+/**
+ * Function: readColonyFile
+ * Usage: if (readColonyFile(filename, engine)) ...
+ * ------------------------------------------------
+ * Resizes engine to fit the colony in the named file and loads it,
+ * parsing straight into the engine as the file is read.  Two formats
+ * are understood:
+ *
+ *  - Colony files hold any number of comment lines beginning with '#',
+ *    the row and column counts on lines of their own, and then one line
+ *    per row in which 'X' is a live cell and '-' a dead one.
+ *
+ *  - Run-length encoded (RLE) pattern files, the format most pattern
+ *    collections use, which begin with a header such as
+ *    "x = 36, y = 9, rule = B3/S23".  In the body, 'b' is a dead cell,
+ *    'o' a live one, '$' ends a row and '!' ends the pattern, and any
+ *    of them may be preceded by a repeat count.  The engine is switched
+ *    to the rule in the header, if there is one.
+ *
+ * Returns false, leaving the engine alone, if the file can't be opened;
+ * raises an error if an RLE file is malformed or names a rule that
+ * isn't a B/S rule.
+ */
+
+bool readColonyFile(const std::string& filename, LifeEngine& engine);
+
+/**
+ * Function: seedRandomColony
+ * Usage: seedRandomColony(engine, 40, 60, 0.5, seed);
+ * ---------------------------------------------------
+ * Resizes engine and brings each cell to life with the given
+ * probability, at a random age.  The colony depends only on the
+ * arguments, so the same seed always produces the same colony, on
+ * any thread and on any platform.
+ */
+
+void seedRandomColony(LifeEngine& engine, int numRows, int numCols,
+                      double density, unsigned long long seed);
+
+#endif
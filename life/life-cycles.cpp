@@ -0,0 +1,38 @@
+/**
+ * File: life-cycles.cpp
+ * ---------------------
+ * Implements the cycle detector.
+ */
+
+#include "life-cycles.h"
+using namespace std;
+
+LifeCycleDetector::LifeCycleDetector(int maxPeriod) {
+    this->maxPeriod = maxPeriod;
+    reset();
+}
+
+void LifeCycleDetector::reset() {
+    period = 0;
+    cycleStart = 0;
+    recent.clear();
+    seenAt.clear();
+}
+
+bool LifeCycleDetector::observe(const LifeEngine& engine) {
+    unsigned long long hash = engine.getStateHash();
+    long generation = engine.getGeneration();
+    map<unsigned long long, long>::iterator it = seenAt.find(hash);
+    if (it != seenAt.end()) {
+        period = int(generation - it->second);
+        cycleStart = it->second;
+        return true;
+    }
+    seenAt[hash] = generation;
+    recent.push_back(hash);
+    if (int(recent.size()) > maxPeriod) {
+        seenAt.erase(recent.front());
+        recent.pop_front();
+    }
+    return false;
+}
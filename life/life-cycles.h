@@ -0,0 +1,70 @@
+/**
+ * File: life-cycles.h
+ * -------------------
+ * Defines a detector that notices when a colony has stopped doing
+ * anything new: when it has died out, settled into a still life, or
+ * fallen into an oscillator that repeats every p generations.  From
+ * then on every generation is a copy of one already seen, so there's
+ * nothing to be gained by stepping any further.
+ *
+ * The detector only ever looks at LifeEngine::getStateHash, which the
+ * engines maintain incrementally, so watching a colony costs a single
+ * lookup per generation however large the colony is.
+ */
+
+#ifndef _life_cycles_h_
+#define _life_cycles_h_
+
+#include <deque>
+#include <map>
+#include "life-engine.h"
+
+class LifeCycleDetector {
+public:
+
+/**
+ * Creates a detector that recognizes cycles of up to maxPeriod
+ * generations.  Longer ones go unnoticed, which keeps the history
+ * it has to remember bounded.
+ */
+
+    LifeCycleDetector(int maxPeriod = 1024);
+
+/**
+ * Forgets every generation seen so far, ready for a new colony.
+ */
+
+    void reset();
+
+/**
+ * Records the engine's current generation and returns true if its
+ * living cells exactly repeat an earlier generation's.  Call it once
+ * for the starting colony and again after every step.
+ */
+
+    bool observe(const LifeEngine& engine);
+
+/**
+ * Once observe has returned true, these give the length of the
+ * cycle (1 for a still life or an empty colony) and the generation
+ * at which the colony first entered it.
+ */
+
+    int getPeriod() const { return period; }
+    long getCycleStart() const { return cycleStart; }
+
+private:
+    int maxPeriod;
+    int period;
+    long cycleStart;
+
+/**
+ * The hashes of the last maxPeriod generations, oldest first, and the
+ * generation at which each of them was seen.
+ */
+
+    std::deque<unsigned long long> recent;
+    std::map<unsigned long long, long> seenAt;
+};
+
+#endif
@@ -0,0 +1,125 @@
+/**
+ * File: life-engine.cpp
+ * ---------------------
+ * Implements the engine factory and the handful of helpers
+ * shared by all LifeEngine subclasses.
+ */
+
+#include <vector>
+#include "life-engine.h"
+#include "life-classic.h"
+#include "life-bitboard.h"
+#include "life-buffered.h"
+#include "life-parallel.h"
+#include "life-sparse.h"
+#include "life-plane.h"
+#include "life-tiled.h"
+#include "life-bits.h"
+#include "error.h"
+#include "strlib.h"
+using namespace std;
+
+string LifeEngine::typeToName(EngineType type) {
+    switch (type) {
+        case Classic: return "Classic";
+        case Bitboard: return "Bitboard";
+        case DoubleBuffered: return "DoubleBuffered";
+        case Parallel: return "Parallel";
+        case Sparse: return "Sparse";
+        case Plane: return "Plane";
+        case Tiled: return "Tiled";
+        default: error("LifeEngine type not recognized.");
+                 return "";
+    }
+}
+
+bool LifeEngine::nameToType(const string& name, EngineType& type) {
+    static const EngineType kAllTypes[] = {
+        Classic, Bitboard, DoubleBuffered, Parallel, Sparse, Plane, Tiled
+    };
+    for (size_t i = 0; i < sizeof(kAllTypes) / sizeof(kAllTypes[0]); i++) {
+        if (equalsIgnoreCase(name, typeToName(kAllTypes[i]))) {
+            type = kAllTypes[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+LifeEngine *LifeEngine::createLifeEngine(EngineType type, int numThreads) {
+    switch (type) {
+        case Classic: return new ClassicLifeEngine();
+        case Bitboard: return new BitboardLifeEngine();
+        case DoubleBuffered: return new DoubleBufferedLifeEngine();
+        case Parallel: return new ParallelLifeEngine(numThreads);
+        case Sparse: return new SparseLifeEngine();
+        case Plane: return new PlaneLifeEngine();
+        case Tiled: return new TiledLifeEngine();
+        default: error("LifeEngine type not recognized.");
+                 return NULL;
+    }
+}
+
+void LifeEngine::getRowAges(int row, unsigned char *ages) const {
+    for (int col = 0; col < nCols; col++) {
+        ages[col] = (unsigned char) getAge(row, col);
+    }
+}
+
+void LifeEngine::getRowLiveBits(int row, unsigned char *bits) const {
+    vector<unsigned char> ages(nCols);
+    if (nCols > 0) getRowAges(row, &ages[0]);
+    packNonzero(ages.empty() ? NULL : &ages[0], nCols, bits);
+}
+
+void LifeEngine::setBoundary(Boundary boundary) {
+    if (boundary != DeadEdges) {
+        error("LifeEngine::setBoundary: this engine only supports dead edges.");
+    }
+    this->boundary = boundary;
+}
+
+/**
+ * Births and deaths are rare next to survivors, so the cells are
+ * compared eight at a time, and within each group of eight only the
+ * cells that actually changed are visited.
+ */
+
+void LifeEngine::tallyRow(long long row, long long firstCol, const unsigned char *before,
+                          const unsigned char *after, int numCells, StepTally& tally) {
+    unsigned long long hash = 0;
+    long long births = 0;
+    long long deaths = 0;
+    int i = 0;
+    for (; i + 8 <= numCells; i += 8) {
+        uint64_t wasAlive = nonzeroBytes(before + i);
+        uint64_t isAlive = nonzeroBytes(after + i);
+        uint64_t flips = wasAlive ^ isAlive;
+        if (flips == 0) continue;
+        births += countBits(flips & isAlive);
+        deaths += countBits(flips & wasAlive);
+        for (; flips != 0; flips &= flips - 1) {
+            hash ^= cellKey(row, firstCol + i + byteOfBit(lowestBit(flips)));
+        }
+    }
+    for (; i < numCells; i++) {
+        if ((before[i] != 0) != (after[i] != 0)) {
+            hash ^= cellKey(row, firstCol + i);
+            if (after[i] != 0) births++;
+            else deaths++;
+        }
+    }
+    tally.hash ^= hash;
+    tally.population += births - deaths;
+}
+
+void LifeEngine::setRule(const LifeRule& rule) {
+    this->rule = rule;
+}
+
+void LifeEngine::checkBounds(int row, int col, const string& method) const {
+    if (row < 0 || row >= nRows || col < 0 || col >= nCols) {
+        error(method + " asked for location (" + integerToString(row) + ", " +
+              integerToString(col) + ") which is outside the colony.");
+    }
+}
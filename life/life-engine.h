@@ -0,0 +1,265 @@
+/**
+ * File: life-engine.h
+ * -------------------
+ * Defines the interface that every Life stepping engine must implement.
+ * The simulation in life.cpp only ever talks to a LifeEngine, so the
+ * representation of the colony (a Grid<int>, packed bitboards, ...) is
+ * free to vary from one engine to the next.
+ */
+
+#ifndef _life_engine_h_
+#define _life_engine_h_
+
+#include <string>
+#include "life-rule.h"
+
+class LifeEngine {
+public:
+
+/**
+ * Identifies the available engine implementations.  They're most
+ * vital to the construction of an engine using the factory method,
+ * as with
+ *
+ *     LifeEngine *engine = LifeEngine::createLifeEngine(LifeEngine::Bitboard);
+ *
+ * Classic is the original three-pass Grid<int> implementation, and
+ * is retained as the reference every other engine is checked against.
+ * Plane has no edges at all: the grid is just a window onto an
+ * unbounded plane that grows as the colony spreads.  Tiled steps the
+ * same buffers as DoubleBuffered a cache-sized strip at a time, with
+ * running column sums in place of the eight-neighbour count.
+ */
+
+    enum EngineType {
+        Classic, Bitboard, DoubleBuffered, Parallel, Sparse, Plane, Tiled
+    };
+
+/**
+ * Identifies what lies beyond the edges of the colony.  With DeadEdges
+ * every cell outside the grid is permanently dead; with Toroidal the
+ * grid wraps around, so the top row neighbours the bottom row and the
+ * leftmost column neighbours the rightmost.
+ */
+
+    enum Boundary {
+        DeadEdges, Toroidal
+    };
+
+/**
+ * Convenience function that gives us a string name for the
+ * engine represented by type.
+ */
+
+    static std::string typeToName(EngineType type);
+
+/**
+ * The inverse of typeToName, ignoring case.  Returns false if no
+ * engine goes by that name.
+ */
+
+    static bool nameToType(const std::string& name, EngineType& type);
+
+/**
+ * Factory method that produces an empty, dynamically allocated
+ * engine of the identified type.  The client owns the result.
+ * numThreads is only consulted by the Parallel engine, where 0
+ * means one thread per processor.
+ */
+
+    static LifeEngine *createLifeEngine(EngineType type, int numThreads = 0);
+
+    LifeEngine() {
+        nRows = 0; nCols = 0; generation = 0; boundary = DeadEdges;
+        stateHash = 0; population = 0; tracking = true;
+    }
+    virtual ~LifeEngine() {}
+
+/**
+ * Discards the current colony and replaces it with an empty one
+ * of the specified dimensions.  The generation count is reset to 0.
+ */
+
+    virtual void resize(int numRows, int numCols) = 0;
+
+/**
+ * Returns the age of the cell at (row, col): 0 for a dead cell,
+ * and 1 through kMaxAge for a living one.  These are exactly the
+ * values LifeDisplay::drawCellAt expects.
+ */
+
+    virtual int getAge(int row, int col) const = 0;
+
+/**
+ * Copies the ages of every cell in row into ages, which must have
+ * room for numCols() of them.  This is getAge for a whole row at
+ * once, for clients that read the entire colony every generation;
+ * engines that store a row contiguously override it with a copy.
+ */
+
+    virtual void getRowAges(int row, unsigned char *ages) const;
+
+/**
+ * Packs which cells in row are alive into (numCols() + 7) / 8 bytes of
+ * bits, with bit k of bits[j] standing for column 8 * j + k.  Engines
+ * that keep their cells as bits already hand them over as they are.
+ */
+
+    virtual void getRowLiveBits(int row, unsigned char *bits) const;
+
+/**
+ * Sets the age of the cell at (row, col).  Ages above kMaxAge are
+ * clamped to kMaxAge, and 0 kills the cell.
+ */
+
+    virtual void setAge(int row, int col, int age) = 0;
+
+/**
+ * Advances the colony by exactly one generation.
+ */
+
+    virtual void step() = 0;
+
+/**
+ * Changes what lies beyond the edges of the colony.  Every engine
+ * supports DeadEdges; engines that can't wrap around raise an error
+ * when asked for Toroidal.
+ */
+
+    virtual void setBoundary(Boundary boundary);
+    Boundary getBoundary() const { return boundary; }
+
+/**
+ * Changes the birth and survival rule, which starts out as Conway's
+ * B3/S23.  The colony is left as it is.  Engines that can't run a
+ * particular rule raise an error.
+ */
+
+    virtual void setRule(const LifeRule& rule);
+    const LifeRule& getRule() const { return rule; }
+
+    int numRows() const { return nRows; }
+    int numCols() const { return nCols; }
+    long getGeneration() const { return generation; }
+
+/**
+ * Returns a Zobrist hash of the set of living cells, ignoring their
+ * ages: the XOR of cellKey over every live cell.  Engines update it
+ * as cells are born and die rather than recomputing it, so reading it
+ * is free.  Two generations with the same living cells always share
+ * a hash; two different ones share it only by a 1 in 2^64 accident.
+ */
+
+    unsigned long long getStateHash() const { return stateHash; }
+
+/**
+ * Returns the number of living cells, kept up to date the same way.
+ */
+
+    long long getPopulation() const { return population; }
+
+/**
+ * Keeping the hash and population up to date costs a little for every
+ * birth and death, which adds up while a large colony is churning.
+ * Tracking is on by default; turning it off makes stepping that much
+ * faster, but getStateHash and getPopulation are meaningless from the
+ * next step onwards.  Turn it back on only before the next resize.
+ */
+
+    void setStateTracking(bool enabled) { tracking = enabled; }
+
+protected:
+
+/**
+ * Every engine tracks its dimensions, generation count, boundary and
+ * rule here, so that the accessors above never need to be overridden.
+ * Subclasses update nRows and nCols in resize, and bump generation
+ * in step.
+ */
+
+    int nRows;
+    int nCols;
+    long generation;
+    Boundary boundary;
+    LifeRule rule;
+
+/**
+ * Subclasses keep these in step with the colony: resize zeroes both,
+ * setAge calls noteAgeChange, and step folds in every birth and death
+ * whenever tracking is set.
+ */
+
+    unsigned long long stateHash;
+    long long population;
+    bool tracking;
+
+/**
+ * Returns the Zobrist key of the cell at (row, col).  The keys are
+ * computed by mixing the coordinates instead of being looked up in a
+ * table, so they cost no memory and work on an unbounded plane.
+ */
+
+    static unsigned long long cellKey(long long row, long long col) {
+        unsigned long long z = (unsigned long long) row * 0x9E3779B97F4A7C15ULL
+                             + (unsigned long long) col * 0xC2B2AE3D27D4EB4FULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+/**
+ * Updates stateHash and population for a cell whose age has gone from
+ * oldAge to newAge.  Only a birth or a death makes any difference.
+ */
+
+    void noteAgeChange(long long row, long long col, int oldAge, int newAge) {
+        if ((oldAge != 0) != (newAge != 0)) {
+            stateHash ^= cellKey(row, col);
+            population += (newAge != 0) ? 1 : -1;
+        }
+    }
+
+/**
+ * The births and deaths found while computing part of a generation,
+ * as changes to stateHash and population.  Disjoint parts of the same
+ * generation can be tallied separately, even on different threads,
+ * and then combined.
+ */
+
+    struct StepTally {
+        unsigned long long hash;
+        long long population;
+        StepTally() { hash = 0; population = 0; }
+    };
+
+/**
+ * For engines that store one byte per cell: adds to tally the births
+ * and deaths among numCells consecutive cells of a row, given the
+ * cells before and after a step.  Cell i is at (row, firstCol + i).
+ */
+
+    static void tallyRow(long long row, long long firstCol, const unsigned char *before,
+                         const unsigned char *after, int numCells, StepTally& tally);
+
+/**
+ * Folds a tally into stateHash and population.
+ */
+
+    void applyTally(const StepTally& tally) {
+        stateHash ^= tally.hash;
+        population += tally.population;
+    }
+
+/**
+ * Raises an error if (row, col) lies outside the colony.  Shared by
+ * all of the getAge and setAge implementations.
+ */
+
+    void checkBounds(int row, int col, const std::string& method) const;
+
+private:
+    LifeEngine(const LifeEngine& original);
+    void operator=(const LifeEngine& rhs);
+};
+
+#endif
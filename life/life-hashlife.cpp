@@ -0,0 +1,411 @@
+/**
+ * File: life-hashlife.cpp
+ * -----------------------
+ * Implements HashLife.  The root node is always centred on the origin,
+ * so a node of level L covers rows and columns [-2^(L-1), 2^(L-1)).
+ * The successor of a level L node is its centre, of level L - 1,
+ * advanced 2^min(stepLog, L - 2) generations.  Whenever the requested
+ * step size or the rule changes, every memoized successor is thrown
+ * away.
+ */
+
+#include <algorithm>
+#include "life-hashlife.h"
+#include "error.h"
+using namespace std;
+
+HashLife::HashLife() {
+    table.assign(1 << 16, (Node *) NULL);
+    nodeCount = 0;
+    root = NULL;
+    clear();
+}
+
+HashLife::~HashLife() {
+    freeAll();
+}
+
+void HashLife::clear() {
+    freeAll();
+    deadCell = new Node;
+    liveCell = new Node;
+    Node *cells[] = { deadCell, liveCell };
+    for (int i = 0; i < 2; i++) {
+        cells[i]->nw = cells[i]->ne = cells[i]->sw = cells[i]->se = NULL;
+        cells[i]->result = NULL;
+        cells[i]->hashNext = NULL;
+        cells[i]->population = i;
+        cells[i]->level = 0;
+        cells[i]->marked = false;
+    }
+    emptyNodes.push_back(deadCell);
+    root = emptyNode(3);
+    generation = 0;
+    stepLog = 0;
+}
+
+bool HashLife::getCell(long long row, long long col) {
+    long long half = 1LL << (root->level - 1);
+    if (row < -half || row >= half || col < -half || col >= half) return false;
+    row += half;
+    col += half;
+    Node *node = root;
+    while (node->level > 0) {
+        half = 1LL << (node->level - 1);
+        bool south = row >= half;
+        bool east = col >= half;
+        node = south ? (east ? node->se : node->sw) : (east ? node->ne : node->nw);
+        if (south) row -= half;
+        if (east) col -= half;
+    }
+    return node == liveCell;
+}
+
+void HashLife::setCell(long long row, long long col, bool alive) {
+    ensureContains(row, col);
+    long long half = 1LL << (root->level - 1);
+    root = setCell(root, row + half, col + half, alive);
+}
+
+void HashLife::setRule(const LifeRule& rule) {
+    if (rule.bornFromNothing()) {
+        error("HashLife::setRule: " + rule.toString() + " gives birth in empty space, "
+              "which an unbounded plane can't hold.");
+    }
+    if (rule == this->rule) return;
+    this->rule = rule;
+    forgetResults();
+}
+
+void HashLife::advancePow2(int k) {
+    if (k < 0 || k > 60) error("HashLife::advancePow2 step exponent out of range.");
+    setStepLog(k);
+    while (root->level < k + 2 || !isCentred(root)) {
+        root = expand(root);
+    }
+    root = successor(expand(root));
+    generation += 1LL << k;
+    if (nodeCount > kGarbageThreshold) collectGarbage();
+}
+
+void HashLife::advance(long long generations) {
+    if (generations < 0) error("HashLife::advance can't run backwards.");
+    for (int k = 62; k >= 0; k--) {
+        if ((generations >> k) & 1) advancePow2(k);
+    }
+}
+
+long long HashLife::population() const {
+    return root->population;
+}
+
+/**
+ * Each edge is found by descending towards it and only ever visiting
+ * the far half of a node when the near half is empty.  The memo keeps
+ * shared subtrees from being searched twice, which matters a great
+ * deal for patterns that have spread out into many identical pieces.
+ */
+
+bool HashLife::boundingBox(long long& top, long long& left, long long& bottom, long long& right) {
+    if (root->population == 0) return false;
+    long long origin = -(1LL << (root->level - 1));
+    long long edges[4];
+    for (int side = 0; side < 4; side++) {
+        map<Node *, long long> memo;
+        edges[side] = origin + edgeOffset(root, side, memo);
+    }
+    top = edges[0];
+    bottom = edges[1];
+    left = edges[2];
+    right = edges[3];
+    return true;
+}
+
+/**
+ * Returns the offset, from the node's top (sides 0 and 1) or left
+ * (sides 2 and 3) edge, of its topmost, bottommost, leftmost or
+ * rightmost live cell.  The node must not be empty.
+ */
+
+long long HashLife::edgeOffset(Node *node, int side, map<Node *, long long>& memo) {
+    if (node->level == 0) return 0;
+    map<Node *, long long>::iterator found = memo.find(node);
+    if (found != memo.end()) return found->second;
+
+    bool vertical = side < 2;
+    bool wantMax = side == 1 || side == 3;
+    Node *lowA = node->nw;                    // the half nearer row or column 0
+    Node *lowB = vertical ? node->ne : node->sw;
+    Node *highA = vertical ? node->sw : node->ne;
+    Node *highB = node->se;
+    long long half = 1LL << (node->level - 1);
+
+    Node *firstA = wantMax ? highA : lowA;
+    Node *firstB = wantMax ? highB : lowB;
+    long long shift = wantMax ? half : 0;
+    if (firstA->population + firstB->population == 0) {
+        firstA = wantMax ? lowA : highA;
+        firstB = wantMax ? lowB : highB;
+        shift = half - shift;
+    }
+    long long result = -1;
+    Node *candidates[] = { firstA, firstB };
+    for (int i = 0; i < 2; i++) {
+        if (candidates[i]->population == 0) continue;
+        long long offset = edgeOffset(candidates[i], side, memo);
+        if (result < 0 || (wantMax ? offset > result : offset < result)) result = offset;
+    }
+    result += shift;
+    memo[node] = result;
+    return result;
+}
+
+size_t HashLife::hashChildren(Node *nw, Node *ne, Node *sw, Node *se) {
+    size_t hash = size_t(nw);
+    hash = hash * 31 + size_t(ne);
+    hash = hash * 31 + size_t(sw);
+    hash = hash * 31 + size_t(se);
+    return hash ^ (hash >> 17);
+}
+
+HashLife::Node *HashLife::join(Node *nw, Node *ne, Node *sw, Node *se) {
+    size_t bucket = hashChildren(nw, ne, sw, se) & (table.size() - 1);
+    for (Node *node = table[bucket]; node != NULL; node = node->hashNext) {
+        if (node->nw == nw && node->ne == ne && node->sw == sw && node->se == se) return node;
+    }
+    Node *node = new Node;
+    node->nw = nw;
+    node->ne = ne;
+    node->sw = sw;
+    node->se = se;
+    node->result = NULL;
+    node->population = nw->population + ne->population + sw->population + se->population;
+    node->level = nw->level + 1;
+    node->marked = false;
+    node->hashNext = table[bucket];
+    table[bucket] = node;
+    nodeCount++;
+    if (nodeCount > int(table.size())) resizeTable();
+    return node;
+}
+
+HashLife::Node *HashLife::emptyNode(int level) {
+    while (int(emptyNodes.size()) <= level) {
+        Node *below = emptyNodes.back();
+        emptyNodes.push_back(join(below, below, below, below));
+    }
+    return emptyNodes[level];
+}
+
+/**
+ * Wraps the node in a border of dead cells, doubling its size while
+ * keeping it centred on the same point.
+ */
+
+HashLife::Node *HashLife::expand(Node *node) {
+    Node *border = emptyNode(node->level - 1);
+    return join(join(border, border, border, node->nw),
+                join(border, border, node->ne, border),
+                join(border, node->sw, border, border),
+                join(node->se, border, border, border));
+}
+
+HashLife::Node *HashLife::centre(Node *node) {
+    return join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+/**
+ * True if every live cell lies within the central quarter of the
+ * node, so that the pattern can grow for a while without any of it
+ * falling off the edge.
+ */
+
+bool HashLife::isCentred(Node *node) {
+    return node->nw->population == node->nw->se->se->population
+        && node->ne->population == node->ne->sw->sw->population
+        && node->sw->population == node->sw->ne->ne->population
+        && node->se->population == node->se->nw->nw->population;
+}
+
+/**
+ * The heart of HashLife.  The node is cut into nine overlapping
+ * subsquares of half its size.  Advancing (or, when only a short step
+ * is wanted, just centring) each of those gives nine squares a quarter
+ * of the size, which regroup into four overlapping half-size squares
+ * whose successors tile the centre of the original node.
+ */
+
+HashLife::Node *HashLife::successor(Node *node) {
+    if (node->result != NULL) return node->result;
+    if (node->population == 0) {
+        node->result = emptyNode(node->level - 1);
+        return node->result;
+    }
+    if (node->level == 2) {
+        node->result = baseSuccessor(node);
+        return node->result;
+    }
+
+    Node *nw = node->nw, *ne = node->ne, *sw = node->sw, *se = node->se;
+    Node *parts[3][3] = {
+        { nw, join(nw->ne, ne->nw, nw->se, ne->sw), ne },
+        { join(nw->sw, nw->se, sw->nw, sw->ne), join(nw->se, ne->sw, sw->ne, se->nw), join(ne->sw, ne->se, se->nw, se->ne) },
+        { sw, join(sw->ne, se->nw, sw->se, se->sw), se }
+    };
+    bool fullSpeed = stepLog >= node->level - 2;
+    Node *inner[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            inner[i][j] = fullSpeed ? successor(parts[i][j]) : centre(parts[i][j]);
+        }
+    }
+    node->result = join(successor(join(inner[0][0], inner[0][1], inner[1][0], inner[1][1])),
+                        successor(join(inner[0][1], inner[0][2], inner[1][1], inner[1][2])),
+                        successor(join(inner[1][0], inner[1][1], inner[2][0], inner[2][1])),
+                        successor(join(inner[1][1], inner[1][2], inner[2][1], inner[2][2])));
+    return node->result;
+}
+
+/**
+ * Advances the centre 2x2 of a 4x4 node by a single generation by
+ * brute force.
+ */
+
+HashLife::Node *HashLife::baseSuccessor(Node *node) {
+    int cells[4][4];
+    for (int row = 0; row < 4; row++) {
+        for (int col = 0; col < 4; col++) {
+            Node *quad = (row < 2) ? (col < 2 ? node->nw : node->ne) : (col < 2 ? node->sw : node->se);
+            Node *cell = (row % 2 == 0) ? (col % 2 == 0 ? quad->nw : quad->ne)
+                                        : (col % 2 == 0 ? quad->sw : quad->se);
+            cells[row][col] = int(cell->population);
+        }
+    }
+    Node *next[4];
+    for (int i = 0; i < 4; i++) {
+        int row = 1 + i / 2;
+        int col = 1 + i % 2;
+        int count = 0;
+        for (int dr = -1; dr <= 1; dr++) {
+            for (int dc = -1; dc <= 1; dc++) {
+                if (dr != 0 || dc != 0) count += cells[row + dr][col + dc];
+            }
+        }
+        bool alive = cells[row][col] ? rule.survives(count) : rule.born(count);
+        next[i] = alive ? liveCell : deadCell;
+    }
+    return join(next[0], next[1], next[2], next[3]);
+}
+
+HashLife::Node *HashLife::setCell(Node *node, long long row, long long col, bool alive) {
+    if (node->level == 0) return alive ? liveCell : deadCell;
+    long long half = 1LL << (node->level - 1);
+    Node *nw = node->nw, *ne = node->ne, *sw = node->sw, *se = node->se;
+    if (row < half) {
+        if (col < half) nw = setCell(nw, row, col, alive);
+        else ne = setCell(ne, row, col - half, alive);
+    } else {
+        if (col < half) sw = setCell(sw, row - half, col, alive);
+        else se = setCell(se, row - half, col - half, alive);
+    }
+    return join(nw, ne, sw, se);
+}
+
+void HashLife::ensureContains(long long row, long long col) {
+    while (true) {
+        long long half = 1LL << (root->level - 1);
+        if (row >= -half && row < half && col >= -half && col < half) return;
+        if (root->level >= 62) error("HashLife coordinates out of range.");
+        root = expand(root);
+    }
+}
+
+void HashLife::setStepLog(int k) {
+    if (k == stepLog) return;
+    stepLog = k;
+    forgetResults();
+}
+
+void HashLife::forgetResults() {
+    for (size_t bucket = 0; bucket < table.size(); bucket++) {
+        for (Node *node = table[bucket]; node != NULL; node = node->hashNext) {
+            node->result = NULL;
+        }
+    }
+}
+
+void HashLife::resizeTable() {
+    vector<Node *> old;
+    old.swap(table);
+    table.assign(old.size() * 2, (Node *) NULL);
+    for (size_t bucket = 0; bucket < old.size(); bucket++) {
+        Node *node = old[bucket];
+        while (node != NULL) {
+            Node *following = node->hashNext;
+            size_t target = hashChildren(node->nw, node->ne, node->sw, node->se) & (table.size() - 1);
+            node->hashNext = table[target];
+            table[target] = node;
+            node = following;
+        }
+    }
+}
+
+/**
+ * Frees every node not reachable from the root or the cache of empty
+ * nodes.  Memoized results may point at nodes that are about to go,
+ * so all of them are forgotten first.
+ */
+
+void HashLife::collectGarbage() {
+    for (size_t bucket = 0; bucket < table.size(); bucket++) {
+        for (Node *node = table[bucket]; node != NULL; node = node->hashNext) {
+            node->result = NULL;
+            node->marked = false;
+        }
+    }
+    mark(root);
+    for (size_t level = 0; level < emptyNodes.size(); level++) {
+        mark(emptyNodes[level]);
+    }
+    for (size_t bucket = 0; bucket < table.size(); bucket++) {
+        Node **link = &table[bucket];
+        while (*link != NULL) {
+            Node *node = *link;
+            if (node->marked) {
+                link = &node->hashNext;
+            } else {
+                *link = node->hashNext;
+                delete node;
+                nodeCount--;
+            }
+        }
+    }
+}
+
+void HashLife::mark(Node *node) {
+    if (node->level == 0 || node->marked) return;
+    node->marked = true;
+    mark(node->nw);
+    mark(node->ne);
+    mark(node->sw);
+    mark(node->se);
+}
+
+void HashLife::freeAll() {
+    for (size_t bucket = 0; bucket < table.size(); bucket++) {
+        Node *node = table[bucket];
+        while (node != NULL) {
+            Node *following = node->hashNext;
+            delete node;
+            node = following;
+        }
+        table[bucket] = NULL;
+    }
+    nodeCount = 0;
+    emptyNodes.clear();
+    if (root != NULL) {
+        delete deadCell;
+        delete liveCell;
+    }
+    root = NULL;
+}
@@ -0,0 +1,129 @@
+/**
+ * File: life-hashlife.h
+ * ---------------------
+ * Defines Gosper's HashLife algorithm for running Life on an unbounded
+ * plane.  The plane is a quadtree whose nodes are hash-consed, so every
+ * distinct square of cells is stored exactly once, and each node
+ * remembers its own future.  Patterns that repeat themselves in space
+ * or in time therefore cost almost nothing to advance, and a single
+ * call can jump 2^k generations at once.
+ *
+ * Unlike the LifeEngine subclasses, HashLife tracks liveness only (no
+ * ages) and has no edges: a glider keeps flying forever.
+ */
+
+#ifndef _life_hashlife_h_
+#define _life_hashlife_h_
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include "life-rule.h"
+
+class HashLife {
+public:
+    HashLife();
+    ~HashLife();
+
+/**
+ * Kills every cell and resets the generation count to 0.
+ */
+
+    void clear();
+
+/**
+ * Reads or writes the cell at (row, col).  Coordinates may be any
+ * value within roughly +/- 2^60, negative ones included.
+ */
+
+    bool getCell(long long row, long long col);
+    void setCell(long long row, long long col, bool alive);
+
+/**
+ * Changes the birth and survival rule, which starts out as Conway's
+ * and isn't affected by clear.  Rules in which cells are born with no
+ * live neighbours raise an error, since they fill the whole plane.
+ */
+
+    void setRule(const LifeRule& rule);
+    const LifeRule& getRule() const { return rule; }
+
+/**
+ * Advances the pattern by exactly 2^k generations.
+ */
+
+    void advancePow2(int k);
+
+/**
+ * Advances the pattern by the specified number of generations, as a
+ * sequence of power-of-two jumps.
+ */
+
+    void advance(long long generations);
+
+    long long getGeneration() const { return generation; }
+
+/**
+ * Returns the number of live cells.
+ */
+
+    long long population() const;
+
+/**
+ * Fills in the smallest rectangle holding every live cell, with both
+ * corners inclusive, and returns true.  Returns false, leaving the
+ * arguments alone, if nothing is alive.
+ */
+
+    bool boundingBox(long long& top, long long& left, long long& bottom, long long& right);
+
+private:
+    struct Node {
+        Node *nw, *ne, *sw, *se; // children, or all NULL for a single cell
+        Node *result;            // memoized centre after 2^stepLog generations
+        Node *hashNext;
+        long long population;
+        int level;               // the node is 2^level cells on a side
+        bool marked;
+    };
+
+/**
+ * Once this many nodes exist, nodes unreachable from the root are
+ * reclaimed between jumps.
+ */
+
+    static const int kGarbageThreshold = 1 << 22;
+
+    Node *root;
+    long long generation;
+    int stepLog;
+    LifeRule rule;
+    Node *deadCell;
+    Node *liveCell;
+    std::vector<Node *> emptyNodes;
+    std::vector<Node *> table;
+    int nodeCount;
+
+    static size_t hashChildren(Node *nw, Node *ne, Node *sw, Node *se);
+    Node *join(Node *nw, Node *ne, Node *sw, Node *se);
+    Node *emptyNode(int level);
+    Node *expand(Node *node);
+    Node *centre(Node *node);
+    Node *successor(Node *node);
+    Node *baseSuccessor(Node *node);
+    bool isCentred(Node *node);
+    Node *setCell(Node *node, long long row, long long col, bool alive);
+    void ensureContains(long long row, long long col);
+    void setStepLog(int k);
+    void forgetResults();
+    void resizeTable();
+    void collectGarbage();
+    void mark(Node *node);
+    void freeAll();
+    long long edgeOffset(Node *node, int side, std::map<Node *, long long>& memo);
+
+    HashLife(const HashLife& original);
+    void operator=(const HashLife& rhs);
+};
+
+#endif
@@ -0,0 +1,36 @@
+/**
+ * File: life-parallel.cpp
+ * -----------------------
+ * Implements the multithreaded row-band stepping engine.
+ */
+
+#include <algorithm>
+#include "life-parallel.h"
+using namespace std;
+
+ParallelLifeEngine::ParallelLifeEngine(int numThreads) : pool(numThreads) {
+    numBands = 0;
+}
+
+void ParallelLifeEngine::step() {
+    fillBorder();
+    numBands = min(nRows, pool.numThreads() * kBandsPerThread);
+    bandTallies.resize(numBands);
+    pool.run(numBands, stepBand, this);
+    StepTally tally;
+    for (int band = 0; band < numBands; band++) {
+        tally.hash ^= bandTallies[band].hash;
+        tally.population += bandTallies[band].population;
+    }
+    swapBuffers(tally);
+}
+
+void ParallelLifeEngine::stepBand(void *data, int band) {
+    ParallelLifeEngine *engine = (ParallelLifeEngine *) data;
+    int rows = engine->nRows;
+    int bands = engine->numBands;
+    StepTally tally;
+    engine->stepRows(int((long long) rows * band / bands),
+                     int((long long) rows * (band + 1) / bands), tally);
+    engine->bandTallies[band] = tally;
+}
@@ -0,0 +1,52 @@
+/**
+ * File: life-parallel.h
+ * ---------------------
+ * Defines a stepping engine that splits every generation into bands of
+ * rows and computes the bands concurrently on a ThreadPool.  Bands
+ * read the current generation and write the next, so the halo rows
+ * just above and below a band are shared, read-only, with the bands
+ * that own them, and no band ever waits on another mid-generation.
+ */
+
+#ifndef _life_parallel_h_
+#define _life_parallel_h_
+
+#include <vector>
+#include "life-buffered.h"
+#include "life-threadpool.h"
+
+class ParallelLifeEngine : public DoubleBufferedLifeEngine {
+public:
+
+/**
+ * Creates an engine that steps on numThreads threads, or one thread
+ * per processor if numThreads is 0.
+ */
+
+    ParallelLifeEngine(int numThreads);
+
+    virtual void step();
+
+private:
+
+/**
+ * Each thread gets several bands, so that work stealing has something
+ * to balance when some bands turn out to be busier than others.
+ */
+
+    static const int kBandsPerThread = 4;
+
+    ThreadPool pool;
+    int numBands;
+
+/**
+ * Each band tallies its own births and deaths, and step combines them
+ * once every band is done.
+ */
+
+    std::vector<StepTally> bandTallies;
+
+    static void stepBand(void *data, int band);
+};
+
+#endif
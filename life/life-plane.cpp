@@ -0,0 +1,200 @@
+/**
+ * File: life-plane.cpp
+ * --------------------
+ * Implements the unbounded plane engine.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "life-plane.h"
+#include "life-constants.h"  // for kMaxAge
+#include "life-kernel.h"
+#include "error.h"
+using namespace std;
+
+static const int kPaddedSize = 66;  // kChunkSize plus a one-cell rim on each side
+
+PlaneLifeEngine::PlaneLifeEngine() {
+    parity = 0;
+    scratch.assign(kPaddedSize * kPaddedSize, 0);
+}
+
+PlaneLifeEngine::~PlaneLifeEngine() {
+    clear();
+}
+
+void PlaneLifeEngine::resize(int numRows, int numCols) {
+    clear();
+    nRows = numRows;
+    nCols = numCols;
+    generation = 0;
+    stateHash = 0;
+    population = 0;
+}
+
+int PlaneLifeEngine::getAge(int row, int col) const {
+    checkBounds(row, col, "PlaneLifeEngine::getAge");
+    Chunk *chunk = findChunk(chunkIndex(row), chunkIndex(col));
+    if (chunk == NULL) return 0;
+    return chunk->cells[parity][(row % kChunkSize) * kChunkSize + col % kChunkSize];
+}
+
+void PlaneLifeEngine::setAge(int row, int col, int age) {
+    checkBounds(row, col, "PlaneLifeEngine::setAge");
+    age = min(max(age, 0), kMaxAge);
+    Chunk *chunk = (age == 0) ? findChunk(chunkIndex(row), chunkIndex(col))
+                              : ensureChunk(chunkIndex(row), chunkIndex(col));
+    if (chunk != NULL) {
+        unsigned char& cell = chunk->cells[parity][(row % kChunkSize) * kChunkSize + col % kChunkSize];
+        noteAgeChange(row, col, cell, age);
+        cell = (unsigned char) age;
+    }
+}
+
+void PlaneLifeEngine::setRule(const LifeRule& rule) {
+    if (rule.bornFromNothing()) {
+        error("PlaneLifeEngine::setRule: " + rule.toString() + " gives birth in empty space, "
+              "which an unbounded plane can't hold.");
+    }
+    LifeEngine::setRule(rule);
+}
+
+void PlaneLifeEngine::step() {
+    growAroundRims();
+    vector<ChunkKey> emptied;
+    for (ChunkMap::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        fillScratch(it->first, it->second);
+        if (!stepChunk(it->first, it->second)) emptied.push_back(it->first);
+    }
+    parity ^= 1;
+    generation++;
+    for (size_t i = 0; i < emptied.size(); i++) {
+        ChunkMap::iterator it = chunks.find(emptied[i]);
+        delete it->second;
+        chunks.erase(it);
+    }
+}
+
+/**
+ * Integer division rounds towards zero, but the chunk holding a
+ * negative coordinate must be found by rounding down.
+ */
+
+int PlaneLifeEngine::chunkIndex(int coordinate) {
+    return (coordinate >= 0) ? coordinate / kChunkSize
+                             : -((-coordinate + kChunkSize - 1) / kChunkSize);
+}
+
+PlaneLifeEngine::Chunk *PlaneLifeEngine::findChunk(int chunkRow, int chunkCol) const {
+    ChunkMap::const_iterator it = chunks.find(ChunkKey(chunkRow, chunkCol));
+    return (it == chunks.end()) ? NULL : it->second;
+}
+
+PlaneLifeEngine::Chunk *PlaneLifeEngine::ensureChunk(int chunkRow, int chunkCol) {
+    Chunk *& chunk = chunks[ChunkKey(chunkRow, chunkCol)];
+    if (chunk == NULL) {
+        chunk = new Chunk;
+        memset(chunk->cells, 0, sizeof(chunk->cells));
+    }
+    return chunk;
+}
+
+/**
+ * A birth can only happen within one cell of a living cell, so a
+ * missing chunk needs to exist only if the chunk beside it has a
+ * living cell on the shared rim.  The new chunks are gathered first
+ * and created afterwards so the map isn't modified mid-iteration.
+ */
+
+void PlaneLifeEngine::growAroundRims() {
+    const int last = kChunkSize - 1;
+    vector<ChunkKey> wanted;
+    for (ChunkMap::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        const unsigned char *cells = it->second->cells[parity];
+        bool north = false, south = false, west = false, east = false;
+        for (int i = 0; i < kChunkSize; i++) {
+            north |= cells[i] != 0;
+            south |= cells[last * kChunkSize + i] != 0;
+            west |= cells[i * kChunkSize] != 0;
+            east |= cells[i * kChunkSize + last] != 0;
+        }
+        int row = it->first.first;
+        int col = it->first.second;
+        if (north) wanted.push_back(ChunkKey(row - 1, col));
+        if (south) wanted.push_back(ChunkKey(row + 1, col));
+        if (west) wanted.push_back(ChunkKey(row, col - 1));
+        if (east) wanted.push_back(ChunkKey(row, col + 1));
+        if (cells[0] != 0) wanted.push_back(ChunkKey(row - 1, col - 1));
+        if (cells[last] != 0) wanted.push_back(ChunkKey(row - 1, col + 1));
+        if (cells[last * kChunkSize] != 0) wanted.push_back(ChunkKey(row + 1, col - 1));
+        if (cells[last * kChunkSize + last] != 0) wanted.push_back(ChunkKey(row + 1, col + 1));
+    }
+    for (size_t i = 0; i < wanted.size(); i++) {
+        ensureChunk(wanted[i].first, wanted[i].second);
+    }
+}
+
+void PlaneLifeEngine::fillScratch(const ChunkKey& key, const Chunk *chunk) {
+    const int last = kChunkSize - 1;
+    unsigned char *padded = &scratch[0];
+    for (int row = 0; row < kChunkSize; row++) {
+        memcpy(padded + (row + 1) * kPaddedSize + 1, chunk->cells[parity] + row * kChunkSize, kChunkSize);
+    }
+    for (int dr = -1; dr <= 1; dr++) {
+        for (int dc = -1; dc <= 1; dc++) {
+            if (dr == 0 && dc == 0) continue;
+            const Chunk *neighbour = findChunk(key.first + dr, key.second + dc);
+            const unsigned char *cells = (neighbour == NULL) ? NULL : neighbour->cells[parity];
+            int firstRow = (dr == 0) ? 0 : (dr < 0 ? last : 0);
+            int numRows = (dr == 0) ? kChunkSize : 1;
+            int firstCol = (dc == 0) ? 0 : (dc < 0 ? last : 0);
+            int numCols = (dc == 0) ? kChunkSize : 1;
+            int toRow = (dr < 0) ? 0 : (dr > 0 ? kPaddedSize - 1 : 1);
+            int toCol = (dc < 0) ? 0 : (dc > 0 ? kPaddedSize - 1 : 1);
+            for (int r = 0; r < numRows; r++) {
+                unsigned char *to = padded + (toRow + r) * kPaddedSize + toCol;
+                if (cells == NULL) {
+                    memset(to, 0, numCols);
+                } else {
+                    memcpy(to, cells + (firstRow + r) * kChunkSize + firstCol, numCols);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Steps each row of the padded scratch with the same kernel as
+ * DoubleBufferedLifeEngine, writing the chunk's other generation.
+ * Births and deaths update the state hash at their coordinates on the
+ * plane.  Returns true if anything is left alive in the chunk.
+ */
+
+bool PlaneLifeEngine::stepChunk(const ChunkKey& key, Chunk *chunk) {
+    const unsigned char *padded = &scratch[0];
+    unsigned char *next = chunk->cells[parity ^ 1];
+    unsigned char differences = 0;
+    unsigned char alive = 0;
+    StepTally tally;
+    for (int x = 0; x < kChunkSize; x++) {
+        const unsigned char *above = padded + x * kPaddedSize + 1;
+        const unsigned char *here = above + kPaddedSize;
+        const unsigned char *below = here + kPaddedSize;
+        unsigned char *to = next + x * kChunkSize;
+        stepCellRow(rule, above, here, below, to, kChunkSize, differences, alive);
+        if (tracking) {
+            tallyRow((long long) key.first * kChunkSize + x, (long long) key.second * kChunkSize,
+                     here, to, kChunkSize, tally);
+        }
+    }
+    applyTally(tally);
+    return alive != 0;
+}
+
+void PlaneLifeEngine::clear() {
+    for (ChunkMap::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        delete it->second;
+    }
+    chunks.clear();
+    parity = 0;
+}
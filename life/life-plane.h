@@ -0,0 +1,83 @@
+/**
+ * File: life-plane.h
+ * ------------------
+ * Defines a stepping engine whose colony has no edges at all.  The
+ * plane is stored as a map of fixed-size square chunks, and a chunk is
+ * only allocated once a living cell could appear in it, so a colony
+ * takes memory in proportion to the area it actually covers.  Before
+ * every step, any chunk with living cells on its rim gets neighbours
+ * on that side; after every step, chunks that have emptied out are
+ * freed again.
+ *
+ * The rows and columns passed to resize describe a window onto the
+ * plane with its top-left corner at the origin.  getAge and setAge
+ * only reach cells inside that window, but the cells outside it keep
+ * on living, so a glider that flies off the edge is still out there.
+ */
+
+#ifndef _life_plane_h_
+#define _life_plane_h_
+
+#include <map>
+#include <utility>
+#include <vector>
+#include "life-engine.h"
+
+class PlaneLifeEngine : public LifeEngine {
+public:
+    PlaneLifeEngine();
+    virtual ~PlaneLifeEngine();
+
+    virtual void resize(int numRows, int numCols);
+    virtual int getAge(int row, int col) const;
+    virtual void setAge(int row, int col, int age);
+
+/**
+ * Accepts any rule except those in which cells are born with no live
+ * neighbours, which would fill the whole infinite plane at once.
+ */
+
+    virtual void setRule(const LifeRule& rule);
+    virtual void step();
+
+/**
+ * Returns the number of chunks currently allocated.
+ */
+
+    int chunkCount() const { return int(chunks.size()); }
+
+private:
+    static const int kChunkSize = 64;
+
+/**
+ * Each chunk holds two generations of kChunkSize x kChunkSize ages,
+ * one byte per cell; cells[parity] is the current one for every chunk.
+ */
+
+    struct Chunk {
+        unsigned char cells[2][kChunkSize * kChunkSize];
+    };
+
+    typedef std::pair<int, int> ChunkKey;
+    typedef std::map<ChunkKey, Chunk *> ChunkMap;
+
+    ChunkMap chunks;
+    int parity;
+
+/**
+ * The chunk being stepped, plus a one-cell rim copied from its eight
+ * neighbours, so the stepping kernel never has to look anything up.
+ */
+
+    std::vector<unsigned char> scratch;
+
+    static int chunkIndex(int coordinate);
+    Chunk *findChunk(int chunkRow, int chunkCol) const;
+    Chunk *ensureChunk(int chunkRow, int chunkCol);
+    void growAroundRims();
+    void fillScratch(const ChunkKey& key, const Chunk *chunk);
+    bool stepChunk(const ChunkKey& key, Chunk *chunk);
+    void clear();
+};
+
+#endif
@@ -0,0 +1,461 @@
+/**
+ * File: life-record.cpp
+ * ---------------------
+ * Implements the recorder and the player.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "life-record.h"
+#include "life-bits.h"
+#include "life-constants.h"  // for kMaxAge
+#include "error.h"
+#include "strlib.h"
+using namespace std;
+
+static const char kMagic[] = "LIFEREC1";
+static const int kMagicLength = 8;
+
+static void putVarint(unsigned char *& out, unsigned long long value);
+static bool getVarint(const unsigned char *& p, const unsigned char *end, unsigned long long& value);
+static bool readVarint(istream& in, unsigned long long& value);
+
+LifeRecorder::LifeRecorder() {
+    nRows = 0;
+    nCols = 0;
+    rowBytes = 0;
+    keyframeInterval = kDefaultKeyframeInterval;
+    lastGeneration = 0;
+    lastKeyframe = 0;
+    written = 0;
+}
+
+LifeRecorder::~LifeRecorder() {
+    close();
+}
+
+bool LifeRecorder::open(const string& filename, const LifeEngine& engine, int keyframeInterval) {
+    close();
+    out.open(filename.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out.is_open()) return false;
+    nRows = engine.numRows();
+    nCols = engine.numCols();
+    this->keyframeInterval = max(keyframeInterval, 1);
+    written = 0;
+    rowBytes = (nCols + 7) / 8;
+    previousBits.assign(size_t(nRows) * rowBytes, 0);
+    flips.assign(previousBits.size(), 0);
+    mask.assign((flips.size() + 7) / 8, 0);
+    row.assign(max(nCols, 1), 0);
+    rowBits.assign(max(rowBytes, 1), 0);
+    payload.assign(2 * size_t(nRows) * nCols + 16, 0);
+    string ruleText = engine.getRule().toString();
+    unsigned char header[64];
+    unsigned char *end = header;
+    putVarint(end, nRows);
+    putVarint(end, nCols);
+    putVarint(end, this->keyframeInterval);
+    putVarint(end, ruleText.size());
+    buffer.assign(kMagic, kMagicLength);
+    buffer.append((const char *) header, end - header);
+    buffer += ruleText;
+    writeKeyframe(engine);
+    return true;
+}
+
+void LifeRecorder::record(const LifeEngine& engine, bool keyframe) {
+    if (!out.is_open()) return;
+    if (engine.numRows() != nRows || engine.numCols() != nCols) {
+        error("LifeRecorder::record: the colony changed size partway through the recording.");
+    }
+    long generation = engine.getGeneration();
+    if (!keyframe && generation == lastGeneration + 1
+        && generation - lastKeyframe < keyframeInterval) {
+        writeDelta(engine);
+    } else {
+        writeKeyframe(engine);
+    }
+}
+
+void LifeRecorder::close() {
+    if (!out.is_open()) return;
+    flush();
+    out.close();
+}
+
+/**
+ * The payload is written through a raw pointer into a buffer that's
+ * always big enough.  A keyframe spends at most one byte on a skip
+ * count for every 127 cells skipped plus one more, and one on an age;
+ * a delta needs its bitplane, with a byte for every eight cells or
+ * fewer, and a mask that's no bigger coded than twice its size, an
+ * eighth of the bitplane's.  Either way no frame needs more than twice
+ * as many bytes as there are cells.
+ */
+
+void LifeRecorder::writeKeyframe(const LifeEngine& engine) {
+    unsigned char *out = &payload[0];
+    long long count = 0;
+    size_t next = 0;
+    for (int r = 0; rowBytes > 0 && r < nRows; r++) {
+        engine.getRowAges(r, &row[0]);
+        packNonzero(&row[0], nCols, &previousBits[size_t(r) * rowBytes]);
+        for (int c = 0; c < nCols; c++) {
+            if (row[c] == 0) continue;
+            size_t index = size_t(r) * nCols + c;
+            putVarint(out, index - next);
+            *out++ = row[c];
+            next = index + 1;
+            count++;
+        }
+    }
+    writeFrame('K', engine.getGeneration(), count, out - &payload[0]);
+    lastKeyframe = engine.getGeneration();
+}
+
+/**
+ * Each row is fetched as one bit per cell and XORed with the same row
+ * of the frame before, which costs the same for every group of eight
+ * cells however many of them changed.  The bytes of the result that
+ * are nonzero are then marked in a mask an eighth its size, packed
+ * sixteen at a time, and only that mask is run-length coded, so even a
+ * churning colony whose changes are scattered everywhere has few runs
+ * to encode.  The nonzero bytes follow the mask as they are.
+ */
+
+void LifeRecorder::writeDelta(const LifeEngine& engine) {
+    for (int r = 0; rowBytes > 0 && r < nRows; r++) {
+        const unsigned char *after = &rowBits[0];
+        engine.getRowLiveBits(r, &rowBits[0]);
+        unsigned char *before = &previousBits[size_t(r) * rowBytes];
+        unsigned char *changed = &flips[size_t(r) * rowBytes];
+        int b = 0;
+        for (; b + 8 <= rowBytes; b += 8) {
+            uint64_t now, then;
+            memcpy(&now, after + b, sizeof now);
+            memcpy(&then, before + b, sizeof then);
+            now ^= then;
+            memcpy(changed + b, &now, sizeof now);
+        }
+        for (; b < rowBytes; b++) changed[b] = after[b] ^ before[b];
+        copy(after, after + rowBytes, before);
+    }
+
+    size_t size = flips.size();
+    unsigned char *out = &payload[0];
+    long long count = 0;
+    if (size > 0) {
+        packNonzero(&flips[0], int(size), &mask[0]);
+        out += encodeRuns(&mask[0], mask.size(), out);
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            if (mask[i / 8] == 0) continue;
+            uint64_t word;
+            memcpy(&word, &flips[i], sizeof word);
+            count += countBits(word);
+            for (int k = 0; k < 8; k++) {
+                *out = flips[i + k];
+                out += (flips[i + k] != 0);
+            }
+        }
+        for (; i < size; i++) {
+            count += countBits(flips[i]);
+            if (flips[i] != 0) *out++ = flips[i];
+        }
+    }
+    writeFrame('D', engine.getGeneration(), count, out - &payload[0]);
+}
+
+/**
+ * The mask alternates between runs of zero bytes and runs of literal
+ * bytes, each introduced by its length, starting with a run of zeros
+ * that may be empty.  Stopping a literal run costs two length bytes,
+ * so it carries on over any gap of one or two zero bytes, which also
+ * keeps the number of runs down.  Both kinds of run are scanned a word
+ * at a time where they can be.
+ */
+
+size_t LifeRecorder::encodeRuns(const unsigned char *bytes, size_t size, unsigned char *out) {
+    const uint64_t highBits = 0x8080808080808080ULL;
+    unsigned char *start = out;
+    size_t i = 0;
+    while (i < size) {
+        size_t zeros = i;
+        while (zeros + 8 <= size && nonzeroBytes(bytes + zeros) == 0) zeros += 8;
+        while (zeros < size && bytes[zeros] == 0) zeros++;
+        size_t literals = zeros;
+        while (literals + 10 <= size) {
+            uint64_t gaps = ~nonzeroBytes(bytes + literals) & ~nonzeroBytes(bytes + literals + 1)
+                          & ~nonzeroBytes(bytes + literals + 2) & highBits;
+            if (gaps != 0) break;
+            literals += 8;
+        }
+        while (literals < size && (bytes[literals] != 0
+                                   || (literals + 1 < size && bytes[literals + 1] != 0)
+                                   || (literals + 2 < size && bytes[literals + 2] != 0))) {
+            literals++;
+        }
+        putVarint(out, zeros - i);
+        putVarint(out, literals - zeros);
+        copy(bytes + zeros, bytes + literals, out);
+        out += literals - zeros;
+        i = literals;
+    }
+    return out - start;
+}
+
+void LifeRecorder::writeFrame(char kind, long generation, long long count, size_t payloadBytes) {
+    unsigned char header[32];
+    unsigned char *end = header;
+    *end++ = kind;
+    putVarint(end, generation);
+    putVarint(end, count);
+    putVarint(end, payloadBytes);
+    buffer.append((const char *) header, end - header);
+    buffer.append((const char *) &payload[0], payloadBytes);
+    lastGeneration = generation;
+    if (buffer.size() >= kFlushSize) flush();
+}
+
+void LifeRecorder::flush() {
+    out.write(buffer.data(), buffer.size());
+    out.flush();
+    written += buffer.size();
+    buffer.clear();
+}
+
+LifePlayer::LifePlayer() {
+    nRows = 0;
+    nCols = 0;
+    generation = 0;
+    firstGeneration = 0;
+    lastGeneration = 0;
+}
+
+/**
+ * Opening a recording walks the frame headers from one end of the file
+ * to the other, skipping over the payloads, to find every keyframe.
+ */
+
+bool LifePlayer::open(const string& filename) {
+    if (in.is_open()) in.close();
+    in.clear();
+    in.open(filename.c_str(), ios::in | ios::binary);
+    if (!in.is_open()) return false;
+    char magic[kMagicLength];
+    if (!in.read(magic, kMagicLength) || memcmp(magic, kMagic, kMagicLength) != 0) {
+        in.close();
+        return false;
+    }
+    this->filename = filename;
+
+    unsigned long long rows, cols, interval, ruleLength;
+    if (!readVarint(in, rows) || !readVarint(in, cols) || !readVarint(in, interval)
+        || !readVarint(in, ruleLength) || ruleLength > 64) {
+        damaged("its header is cut short");
+    }
+    string ruleText(ruleLength, ' ');
+    if (ruleLength > 0 && !in.read(&ruleText[0], ruleLength)) damaged("its header is cut short");
+    if (!LifeRule::parse(ruleText, rule)) damaged("its rule " + ruleText + " isn't a B/S rule");
+    nRows = int(rows);
+    nCols = int(cols);
+    ages.assign(size_t(nRows) * nCols, 0);
+
+    streampos start = in.tellg();
+    in.seekg(0, ios::end);
+    streampos end = in.tellg();
+    in.seekg(start);
+    keyframes.clear();
+    while (true) {
+        streampos offset = in.tellg();
+        char kind;
+        long frameGeneration;
+        long long count;
+        unsigned long long payloadBytes;
+        if (!readFrameHeader(kind, frameGeneration, count, payloadBytes)) break;
+        if ((unsigned long long) (end - in.tellg()) < payloadBytes) break;
+        in.seekg(payloadBytes, ios::cur);
+        if (kind == 'K') {
+            Keyframe keyframe = { frameGeneration, offset };
+            keyframes.push_back(keyframe);
+        } else if (kind != 'D' || keyframes.empty() || frameGeneration != lastGeneration + 1) {
+            damaged("its frames are out of order");
+        }
+        lastGeneration = frameGeneration;
+    }
+    if (keyframes.empty()) damaged("it has no frames at all");
+    firstGeneration = keyframes[0].generation;
+    in.clear();
+    generation = lastGeneration + 1;
+    seek(firstGeneration);
+    return true;
+}
+
+int LifePlayer::getAge(int row, int col) const {
+    if (row < 0 || row >= nRows || col < 0 || col >= nCols) {
+        error("LifePlayer::getAge asked for location (" + integerToString(row) + ", " +
+              integerToString(col) + ") which is outside the colony.");
+    }
+    return ages[size_t(row) * nCols + col];
+}
+
+bool LifePlayer::step() {
+    if (generation >= lastGeneration) return false;
+    readFrame();
+    return true;
+}
+
+/**
+ * Seeking forwards past no keyframe just keeps on reading from where
+ * the player is, which is the common case when skipping ahead a little.
+ */
+
+void LifePlayer::seek(long target) {
+    if (target < firstGeneration || target > lastGeneration) {
+        error("LifePlayer::seek: generation " + integerToString(target) + " isn't in the recording.");
+    }
+    size_t k = keyframes.size() - 1;
+    while (keyframes[k].generation > target) k--;
+    if (target < generation || keyframes[k].generation > generation) {
+        in.clear();
+        in.seekg(keyframes[k].offset);
+        readFrame();
+    }
+    while (generation < target) readFrame();
+}
+
+bool LifePlayer::readFrameHeader(char& kind, long& frameGeneration, long long& count,
+                                 unsigned long long& payloadBytes) {
+    unsigned long long value, number;
+    if (!in.get(kind)) return false;
+    if (!readVarint(in, value) || !readVarint(in, number) || !readVarint(in, payloadBytes)) {
+        return false;
+    }
+    frameGeneration = long(value);
+    count = (long long) number;
+    return true;
+}
+
+void LifePlayer::readFrame() {
+    char kind;
+    long frameGeneration;
+    long long count;
+    unsigned long long payloadBytes;
+    if (!readFrameHeader(kind, frameGeneration, count, payloadBytes)) {
+        damaged("a frame is cut short");
+    }
+    payload.resize(payloadBytes);
+    if (payloadBytes > 0 && !in.read((char *) &payload[0], payloadBytes)) {
+        damaged("a frame is cut short");
+    }
+    if (kind == 'K') {
+        applyKeyframe(count);
+    } else {
+        applyDelta(count);
+    }
+    generation = frameGeneration;
+}
+
+void LifePlayer::applyKeyframe(long long count) {
+    fill(ages.begin(), ages.end(), 0);
+    const unsigned char *p = payload.empty() ? NULL : &payload[0];
+    const unsigned char *end = p + payload.size();
+    unsigned long long index = 0;
+    for (long long i = 0; i < count; i++) {
+        unsigned long long skip;
+        if (!getVarint(p, end, skip) || p == end) damaged("a keyframe is cut short");
+        index += skip;
+        unsigned char age = *p++;
+        if (index >= ages.size() || age == 0 || age > kMaxAge) damaged("a keyframe has a bad cell");
+        ages[index++] = age;
+    }
+}
+
+/**
+ * Every survivor grows a generation older first, which also takes
+ * every cell about to die off age 0, so that flipping a changed cell
+ * is then a matter of whether its age is 0.
+ */
+
+void LifePlayer::applyDelta(long long count) {
+    for (size_t i = 0; i < ages.size(); i++) {
+        unsigned char age = ages[i];
+        ages[i] = (unsigned char) (age + (age != 0 && age < kMaxAge));
+    }
+    const unsigned char *p = payload.empty() ? NULL : &payload[0];
+    const unsigned char *end = p + payload.size();
+    size_t rowBytes = (nCols + 7) / 8;
+    size_t planeBytes = size_t(nRows) * rowBytes;
+    size_t maskBytes = (planeBytes + 7) / 8;
+    mask.assign(maskBytes, 0);
+    size_t position = 0;
+    while (position < maskBytes) {
+        unsigned long long zeros = 0, literals = 0;
+        if (!getVarint(p, end, zeros) || !getVarint(p, end, literals)
+            || (unsigned long long) (end - p) < literals
+            || zeros + literals > maskBytes - position) {
+            damaged("a delta is cut short");
+        }
+        position += zeros;
+        copy(p, p + literals, mask.begin() + position);
+        p += literals;
+        position += literals;
+    }
+
+    long long flipped = 0;
+    for (size_t m = 0; m < maskBytes; m++) {
+        for (unsigned char present = mask[m]; present != 0; present &= present - 1) {
+            size_t byte = m * 8 + lowestBit(present);
+            if (p == end || byte >= planeBytes) damaged("a delta is cut short");
+            size_t row = byte / rowBytes;
+            int col = int(byte % rowBytes) * 8;
+            for (unsigned char bits = *p++; bits != 0; bits &= bits - 1) {
+                int k = lowestBit(bits);
+                if (col + k >= nCols) damaged("a delta has a bad cell");
+                unsigned char& age = ages[row * nCols + col + k];
+                age = (age == 0) ? 1 : 0;
+                flipped++;
+            }
+        }
+    }
+    if (p != end || flipped != count) damaged("a delta has the wrong number of cells");
+}
+
+void LifePlayer::damaged(const string& problem) const {
+    error("LifePlayer: " + filename + " is damaged: " + problem + ".");
+}
+
+/**
+ * Varints hold seven bits per byte, lowest first, with the top bit set
+ * on every byte but the last.
+ */
+
+static void putVarint(unsigned char *& out, unsigned long long value) {
+    while (value >= 0x80) {
+        *out++ = (unsigned char) ((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    *out++ = (unsigned char) value;
+}
+
+static bool getVarint(const unsigned char *& p, const unsigned char *end, unsigned long long& value) {
+    value = 0;
+    for (int shift = 0; p != end && shift < 64; shift += 7) {
+        unsigned char byte = *p++;
+        value |= (unsigned long long) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+static bool readVarint(istream& in, unsigned long long& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        char ch;
+        if (!in.get(ch)) return false;
+        unsigned char byte = ch;
+        value |= (unsigned long long) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
@@ -0,0 +1,191 @@
+/**
+ * File: life-record.h
+ * -------------------
+ * Defines a recorder that saves a run to a file one generation at a
+ * time, and a player that reads it back.  A recording holds a keyframe
+ * with every living cell every so often, and between keyframes only
+ * the cells that were born or died in each generation.  Ages aren't
+ * stored for those, since they follow from the births and deaths
+ * alone: survivors grow one generation older and newborns start at 1.
+ *
+ * The file is written strictly front to back and never patched, so a
+ * run that's cut short still leaves a playable recording of every
+ * generation that made it to disk.
+ *
+ * Layout, with every number an unsigned LEB128 varint:
+ *
+ *     "LIFEREC1" rows cols keyframeInterval ruleLength rule
+ *     then frames, each:  kind generation count payloadBytes payload
+ *
+ * kind is 'K' for a keyframe and 'D' for a delta.  A keyframe's
+ * payload lists its count living cells in row-major order, each as the
+ * number of cells skipped since the previous one followed by its age
+ * in a single byte.  A delta's payload starts from the XOR of the two
+ * generations' bitplanes, one bit per cell and each row padded to a
+ * whole byte.  A mask with one bit for each byte of that bitplane,
+ * set where the byte is nonzero, comes first, run-length coded as
+ * alternating runs of zero bytes and of literal bytes, each preceded
+ * by its length; then come the nonzero bytes of the bitplane in order.
+ * count is the number of cells that changed.  A long stretch of
+ * unchanged cells costs one or two bytes however long it is, and a
+ * churning colony costs no more than its bitplane and an eighth.
+ */
+
+#ifndef _life_record_h_
+#define _life_record_h_
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "life-engine.h"
+#include "life-rule.h"
+
+class LifeRecorder {
+public:
+    static const int kDefaultKeyframeInterval = 100;
+
+    LifeRecorder();
+    ~LifeRecorder();
+
+/**
+ * Creates the named file and records the engine's current generation
+ * as its first keyframe.  Returns false if the file can't be created.
+ * Every keyframeInterval generations after that another keyframe is
+ * written, which bounds how far the player has to replay to seek.
+ */
+
+    bool open(const std::string& filename, const LifeEngine& engine,
+              int keyframeInterval = kDefaultKeyframeInterval);
+
+/**
+ * Records the engine's current generation, which should be one step
+ * on from the last one recorded.  If it isn't, because the engine
+ * was stepped without recording, a keyframe is written instead of a
+ * delta.  A delta only says which cells were born or died, so pass
+ * true for keyframe if any cells were edited since the last frame.
+ */
+
+    void record(const LifeEngine& engine, bool keyframe = false);
+
+/**
+ * Writes out anything still buffered and closes the file.  The
+ * destructor does the same for a recorder that's still open.
+ */
+
+    void close();
+
+/**
+ * Returns the size of the recording so far, including whatever is
+ * still waiting in the buffer.
+ */
+
+    long long bytesWritten() const { return written + (long long) buffer.size(); }
+
+private:
+
+/**
+ * Frames are encoded into buffer and only handed to the stream a
+ * megabyte at a time, so the cost of writing is one large write per
+ * many generations rather than several small ones per frame.
+ */
+
+    static const size_t kFlushSize = 1 << 20;
+
+    std::ofstream out;
+    int nRows;
+    int nCols;
+    int keyframeInterval;
+    long lastGeneration;
+    long lastKeyframe;
+    long long written;
+    int rowBytes;                             // bytes per row of a bitplane
+    std::vector<unsigned char> previousBits;  // which cells were alive at the last frame
+    std::vector<unsigned char> flips;         // which cells changed since then
+    std::vector<unsigned char> mask;          // which bytes of flips are nonzero
+    std::vector<unsigned char> row;           // scratch for one row of the engine
+    std::vector<unsigned char> rowBits;       // scratch for one row as bits
+    std::vector<unsigned char> payload;       // the frame being encoded
+    std::string buffer;
+
+    void writeKeyframe(const LifeEngine& engine);
+    void writeDelta(const LifeEngine& engine);
+    void writeFrame(char kind, long generation, long long count, size_t payloadBytes);
+    static size_t encodeRuns(const unsigned char *bytes, size_t size, unsigned char *out);
+    void flush();
+
+    LifeRecorder(const LifeRecorder& original);
+    void operator=(const LifeRecorder& rhs);
+};
+
+class LifePlayer {
+public:
+    LifePlayer();
+
+/**
+ * Opens the named recording and positions the player on its first
+ * generation.  Returns false if the file can't be opened or isn't a
+ * recording; raises an error if the recording is damaged.  A final
+ * frame cut off partway through is silently ignored.
+ */
+
+    bool open(const std::string& filename);
+
+    int numRows() const { return nRows; }
+    int numCols() const { return nCols; }
+    const LifeRule& getRule() const { return rule; }
+    long getGeneration() const { return generation; }
+    long getFirstGeneration() const { return firstGeneration; }
+    long getLastGeneration() const { return lastGeneration; }
+
+/**
+ * Returns the age of the cell at (row, col) in the current generation.
+ */
+
+    int getAge(int row, int col) const;
+
+/**
+ * Moves on to the next recorded generation and returns true, or
+ * returns false if the player is already on the last one.
+ */
+
+    bool step();
+
+/**
+ * Moves to the given generation, which must lie between the first and
+ * the last.  Only the frames after the nearest keyframe at or before
+ * it are replayed.
+ */
+
+    void seek(long target);
+
+private:
+    struct Keyframe {
+        long generation;
+        std::streampos offset;
+    };
+
+    std::ifstream in;
+    std::string filename;
+    int nRows;
+    int nCols;
+    LifeRule rule;
+    long generation;
+    long firstGeneration;
+    long lastGeneration;
+    std::vector<Keyframe> keyframes;
+    std::vector<unsigned char> ages;
+    std::vector<unsigned char> mask;
+    std::vector<unsigned char> payload;
+
+    bool readFrameHeader(char& kind, long& frameGeneration, long long& count,
+                         unsigned long long& payloadBytes);
+    void readFrame();
+    void applyKeyframe(long long count);
+    void applyDelta(long long count);
+    void damaged(const std::string& problem) const;
+
+    LifePlayer(const LifePlayer& original);
+    void operator=(const LifePlayer& rhs);
+};
+
+#endif
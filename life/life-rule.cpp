@@ -0,0 +1,107 @@
+/**
+ * File: life-rule.cpp
+ * -------------------
+ * Implements rule parsing and printing.
+ */
+
+#include <cctype>
+#include "life-rule.h"
+using namespace std;
+
+/**
+ * Well-known rules that can be asked for by name.  Names are compared
+ * ignoring case, spaces and punctuation, so "Day & Night" and
+ * "daynight" both work.
+ */
+
+struct NamedRule {
+    const char *name;
+    const char *notation;
+};
+
+static const NamedRule kNamedRules[] = {
+    { "conway", "B3/S23" },
+    { "life", "B3/S23" },
+    { "highlife", "B36/S23" },
+    { "seeds", "B2/S" },
+    { "daynight", "B3678/S34678" },
+    { "lifewithoutdeath", "B3/S012345678" },
+    { "maze", "B3/S12345" },
+    { "replicator", "B1357/S1357" },
+    { "diamoeba", "B35678/S5678" },
+    { "2x2", "B36/S125" },
+    { "morley", "B368/S245" }
+};
+
+static string simplify(const string& text);
+
+LifeRule::LifeRule() {
+    birthMask = 0x8;
+    survivalMask = 0xC;
+}
+
+bool LifeRule::parse(const string& notation, LifeRule& rule) {
+    string text = simplify(notation);
+    for (size_t i = 0; i < sizeof(kNamedRules) / sizeof(kNamedRules[0]); i++) {
+        if (text == kNamedRules[i].name) return parse(kNamedRules[i].notation, rule);
+    }
+
+    unsigned int birth, survival;
+    size_t slash = notation.find('/');
+    size_t b = text.find('b');
+    size_t s = text.find('s');
+    if (b == 0 && s != string::npos) {
+        if (!parseCounts(text.substr(1, s - 1), birth)) return false;
+        if (!parseCounts(text.substr(s + 1), survival)) return false;
+    } else if (s == 0 && b != string::npos) {
+        if (!parseCounts(text.substr(1, b - 1), survival)) return false;
+        if (!parseCounts(text.substr(b + 1), birth)) return false;
+    } else if (b == string::npos && s == string::npos && slash != string::npos) {
+        string trimmed;
+        for (size_t i = 0; i < notation.size(); i++) {
+            if (!isspace((unsigned char) notation[i])) trimmed += notation[i];
+        }
+        slash = trimmed.find('/');
+        if (!parseCounts(trimmed.substr(0, slash), survival)) return false;
+        if (!parseCounts(trimmed.substr(slash + 1), birth)) return false;
+    } else {
+        return false;
+    }
+    rule.birthMask = birth;
+    rule.survivalMask = survival;
+    return true;
+}
+
+string LifeRule::toString() const {
+    string result = "B";
+    for (int count = 0; count <= 8; count++) {
+        if (born(count)) result += char('0' + count);
+    }
+    result += "/S";
+    for (int count = 0; count <= 8; count++) {
+        if (survives(count)) result += char('0' + count);
+    }
+    return result;
+}
+
+bool LifeRule::parseCounts(const string& digits, unsigned int& mask) {
+    mask = 0;
+    for (size_t i = 0; i < digits.size(); i++) {
+        if (digits[i] < '0' || digits[i] > '8') return false;
+        mask |= 1u << (digits[i] - '0');
+    }
+    return true;
+}
+
+/**
+ * Lowercases text and drops everything but letters and digits.
+ */
+
+static string simplify(const string& text) {
+    string result;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char ch = text[i];
+        if (isalnum(ch)) result += char(tolower(ch));
+    }
+    return result;
+}
@@ -0,0 +1,88 @@
+/**
+ * File: life-rule.h
+ * -----------------
+ * Defines the birth and survival rule a colony evolves under.  Conway's
+ * rule is only one of a family of "outer totalistic" rules, in which a
+ * cell's fate depends on nothing but whether it's alive and how many
+ * of its eight neighbours are.  Such a rule is written in B/S notation:
+ * B3/S23 means a dead cell with 3 live neighbours is born and a live
+ * cell with 2 or 3 survives, while HighLife is B36/S23 and Seeds, in
+ * which nothing survives at all, is B2/S.
+ *
+ * A LifeRule is compiled into a pair of bitmasks indexed by neighbour
+ * count, so looking up a cell's fate is a shift and an AND however
+ * many counts the rule mentions.
+ */
+
+#ifndef _life_rule_h_
+#define _life_rule_h_
+
+#include <string>
+
+class LifeRule {
+public:
+
+/**
+ * Creates Conway's rule, B3/S23.
+ */
+
+    LifeRule();
+
+/**
+ * Parses notation into rule and returns true, or returns false and
+ * leaves rule alone if notation can't be understood.  Accepted forms
+ * are B/S notation in either case and with or without the slash
+ * ("B36/S23", "b36s23"), the older S/B form that lists the survival
+ * counts first ("23/36"), and the names of a few well-known rules
+ * ("Conway", "HighLife", "Seeds", "Day & Night", ...), ignoring case.
+ */
+
+    static bool parse(const std::string& notation, LifeRule& rule);
+
+/**
+ * Returns whether a dead cell with count live neighbours is born, and
+ * whether a live one survives.
+ */
+
+    bool born(int count) const { return (birthMask >> count) & 1; }
+    bool survives(int count) const { return (survivalMask >> count) & 1; }
+
+/**
+ * Returns the whole rule as a single table: bit count says whether a
+ * dead cell with count neighbours is born, and bit 9 + count whether
+ * a live one survives.  The stepping kernels look cells up with
+ *
+ *     (table >> (count + 9 * alive)) & 1
+ */
+
+    unsigned int table() const { return birthMask | (survivalMask << 9); }
+
+/**
+ * Returns true for rules under which a dead cell with no live
+ * neighbours at all is born.  Empty space then fills up with life
+ * every other generation, which no unbounded plane can represent.
+ */
+
+    bool bornFromNothing() const { return (birthMask & 1) != 0; }
+
+    bool isConway() const { return birthMask == 0x8 && survivalMask == 0xC; }
+
+/**
+ * Returns the rule in canonical B/S notation, such as "B36/S23".
+ */
+
+    std::string toString() const;
+
+    bool operator==(const LifeRule& other) const {
+        return birthMask == other.birthMask && survivalMask == other.survivalMask;
+    }
+    bool operator!=(const LifeRule& other) const { return !(*this == other); }
+
+private:
+    unsigned int birthMask;    // bit k set if a dead cell with k neighbours is born
+    unsigned int survivalMask; // bit k set if a live cell with k neighbours survives
+
+    static bool parseCounts(const std::string& digits, unsigned int& mask);
+};
+
+#endif
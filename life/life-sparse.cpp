@@ -0,0 +1,86 @@
+/**
+ * File: life-sparse.cpp
+ * ---------------------
+ * Implements the tile-tracking stepping engine.
+ */
+
+#include <algorithm>
+#include "life-sparse.h"
+using namespace std;
+
+void SparseLifeEngine::resize(int numRows, int numCols) {
+    DoubleBufferedLifeEngine::resize(numRows, numCols);
+    tileRows = (numRows + kTileSize - 1) / kTileSize;
+    tileCols = (numCols + kTileSize - 1) / kTileSize;
+    active.assign(tileRows * tileCols, 1);
+    changed.assign(tileRows * tileCols, 0);
+    lastActiveCount = 0;
+}
+
+void SparseLifeEngine::setAge(int row, int col, int age) {
+    DoubleBufferedLifeEngine::setAge(row, col, age);
+    markActiveAround(row / kTileSize, col / kTileSize);
+}
+
+void SparseLifeEngine::setBoundary(Boundary boundary) {
+    DoubleBufferedLifeEngine::setBoundary(boundary);
+    fill(active.begin(), active.end(), 1);
+}
+
+/**
+ * A quiet tile is only guaranteed to stay quiet under the rule that
+ * made it so, so a new rule wakes every tile up again.
+ */
+
+void SparseLifeEngine::setRule(const LifeRule& rule) {
+    DoubleBufferedLifeEngine::setRule(rule);
+    fill(active.begin(), active.end(), 1);
+}
+
+void SparseLifeEngine::step() {
+    fillBorder();
+    lastActiveCount = 0;
+    StepTally tally;
+    for (int tr = 0; tr < tileRows; tr++) {
+        for (int tc = 0; tc < tileCols; tc++) {
+            int tile = tr * tileCols + tc;
+            changed[tile] = 0;
+            if (!active[tile]) continue;
+            lastActiveCount++;
+            int row = tr * kTileSize;
+            int col = tc * kTileSize;
+            changed[tile] = stepRegion(row, min(row + kTileSize, nRows),
+                                       col, min(col + kTileSize, nCols), tally);
+        }
+    }
+    swapBuffers(tally);
+
+    fill(active.begin(), active.end(), 0);
+    for (int tr = 0; tr < tileRows; tr++) {
+        for (int tc = 0; tc < tileCols; tc++) {
+            if (changed[tr * tileCols + tc]) markActiveAround(tr, tc);
+        }
+    }
+}
+
+/**
+ * Under Toroidal, a change on one edge of the grid can affect the
+ * tiles on the opposite edge, so the neighbourhood wraps around too.
+ */
+
+void SparseLifeEngine::markActiveAround(int tileRow, int tileCol) {
+    bool wrap = (boundary == Toroidal);
+    for (int dr = -1; dr <= 1; dr++) {
+        for (int dc = -1; dc <= 1; dc++) {
+            int tr = tileRow + dr;
+            int tc = tileCol + dc;
+            if (wrap) {
+                tr = (tr + tileRows) % tileRows;
+                tc = (tc + tileCols) % tileCols;
+            } else if (tr < 0 || tr >= tileRows || tc < 0 || tc >= tileCols) {
+                continue;
+            }
+            active[tr * tileCols + tc] = 1;
+        }
+    }
+}
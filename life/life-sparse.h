@@ -0,0 +1,52 @@
+/**
+ * File: life-sparse.h
+ * -------------------
+ * Defines a stepping engine that only recomputes the parts of the
+ * colony that can possibly change.  The grid is divided into square
+ * tiles; a tile is recomputed only if it, or one of its eight
+ * neighbours, changed during the previous generation.  Once a region
+ * settles into a still life and its cells reach kMaxAge, it costs
+ * nothing at all to step.
+ */
+
+#ifndef _life_sparse_h_
+#define _life_sparse_h_
+
+#include <vector>
+#include "life-buffered.h"
+
+class SparseLifeEngine : public DoubleBufferedLifeEngine {
+public:
+    virtual void resize(int numRows, int numCols);
+    virtual void setAge(int row, int col, int age);
+    virtual void setBoundary(Boundary boundary);
+    virtual void setRule(const LifeRule& rule);
+    virtual void step();
+
+/**
+ * Returns the number of tiles recomputed by the most recent step.
+ */
+
+    int activeTileCount() const { return lastActiveCount; }
+
+private:
+    static const int kTileSize = 32;
+
+    int tileRows;
+    int tileCols;
+    int lastActiveCount;
+
+/**
+ * A skipped tile is left alone in the spare buffer, which is only
+ * correct because a tile is skipped just when its contents were the
+ * same in the last two generations.  Anything that edits the current
+ * generation directly has to mark the surrounding tiles active.
+ */
+
+    std::vector<char> active;
+    std::vector<char> changed;
+
+    void markActiveAround(int tileRow, int tileCol);
+};
+
+#endif
@@ -0,0 +1,343 @@
+/**
+ * File: life-sweep.cpp
+ * --------------------
+ * A headless driver for Monte Carlo studies of random colonies.  It
+ * seeds thousands of independent colonies, runs each one until it dies
+ * out, settles or starts to oscillate (or a generation limit is hit),
+ * and records how long it lived and what was left.  The runs are spread
+ * across every core, and each has its own seed, so a sweep gives the
+ * same results however many threads it runs on, and any single run can
+ * be replayed with life-bench.
+ *
+ * Like life-bench, this file has its own main and builds against the
+ * stub library:
+ *
+ *     g++ -O3 -IStanfordCPPLib -o life-sweep life-sweep.cpp life-colony.cpp \
+ *         life-engine.cpp life-classic.cpp life-bitboard.cpp life-buffered.cpp \
+ *         life-parallel.cpp life-sparse.cpp life-plane.cpp life-tiled.cpp \
+ *         life-threadpool.cpp life-cycles.cpp life-rule.cpp \
+ *         -LStanfordCPPLib -lStubCPPLib -lpthread
+ *
+ * Usage: life-sweep [options]
+ *
+ *     --runs <n>             colonies per density (1000)
+ *     --size <rows>x<cols>   size of every colony (50x50)
+ *     --densities <p,q,...>  starting densities to sweep (0.5)
+ *     --seed <n>             seed of the first run; run i uses seed + i (1)
+ *     --max-generations <n>  give up on a colony after this many (10000)
+ *     --engine <name>        engine for every run (Bitboard)
+ *     --threads <n>          threads to spread the runs across (0 = one per core)
+ *     --wrap                 wrap the edges around (a toroidal board)
+ *     --rule <rule>          run every colony under this rule (B3/S23)
+ *     --csv <file>           write one line per run to file
+ *     --json <file>          write the per-density summary to file
+ *     --help                 describe these options and stop
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+#include "life-engine.h"
+#include "life-colony.h"
+#include "life-cycles.h"
+#include "life-threadpool.h"
+using namespace std;
+
+struct SweepOptions {
+    int runs;
+    int numRows;
+    int numCols;
+    vector<double> densities;
+    unsigned long long seed;
+    long maxGenerations;
+    LifeEngine::EngineType type;
+    int numThreads;
+    bool wrap;
+    LifeRule rule;
+    string csvFile;
+    string jsonFile;
+};
+
+/**
+ * What became of one colony.  Unless the colony hit maxGenerations
+ * first, lifetime is the generation at which it entered its final
+ * cycle, and period is the length of that cycle (1 for a still life
+ * or an empty colony).
+ */
+
+struct RunResult {
+    unsigned long long seed;
+    double density;
+    long long initialPopulation;
+    long long finalPopulation;
+    long lifetime;
+    int period;
+    bool settled;
+};
+
+/**
+ * Everything the worker threads share.  Each run writes only its own
+ * slot of results, so no locking is needed.
+ */
+
+struct Sweep {
+    const SweepOptions *options;
+    vector<RunResult> results;
+};
+
+/**
+ * The figures gathered for one density.
+ */
+
+struct DensitySummary {
+    int runs;
+    int settled;
+    int extinct;
+    int stillLifes;
+    double totalLifetime;
+    double totalFinalPopulation;
+    long maxLifetime;
+};
+
+static void parseOptions(int argc, char *argv[], SweepOptions& options);
+static bool parseDensities(const string& value, vector<double>& densities);
+static void usage(const string& problem);
+static double now();
+static void runColony(void *data, int run);
+static vector<DensitySummary> summarize(const SweepOptions& options,
+                                        const vector<RunResult>& results);
+static void reportSummary(const SweepOptions& options, const vector<RunResult>& results);
+static void writeCSV(const string& filename, const vector<RunResult>& results);
+static void writeJSON(const string& filename, const SweepOptions& options,
+                      const vector<RunResult>& results);
+
+int main(int argc, char *argv[]) {
+    SweepOptions options;
+    parseOptions(argc, argv, options);
+
+    Sweep sweep;
+    sweep.options = &options;
+    sweep.results.resize(options.runs * options.densities.size());
+    ThreadPool pool(options.numThreads);
+    double start = now();
+    pool.run(int(sweep.results.size()), runColony, &sweep);
+    double elapsed = now() - start;
+
+    reportSummary(options, sweep.results);
+    cout << sweep.results.size() << " colonies on " << pool.numThreads()
+         << " threads in " << elapsed << " seconds" << endl;
+    if (!options.csvFile.empty()) writeCSV(options.csvFile, sweep.results);
+    if (!options.jsonFile.empty()) writeJSON(options.jsonFile, options, sweep.results);
+    return 0;
+}
+
+static void parseOptions(int argc, char *argv[], SweepOptions& options) {
+    options.runs = 1000;
+    options.numRows = 50;
+    options.numCols = 50;
+    options.densities.assign(1, 0.5);
+    options.seed = 1;
+    options.maxGenerations = 10000;
+    options.type = LifeEngine::Bitboard;
+    options.numThreads = 0;
+    options.wrap = false;
+    for (int i = 1; i < argc; i++) {
+        string flag = argv[i];
+        if (flag == "--help") usage("");
+        if (flag == "--wrap") {
+            options.wrap = true;
+            continue;
+        }
+        if (i + 1 >= argc) usage("missing value for " + flag);
+        string value = argv[++i];
+        istringstream in(value);
+        bool ok = true;
+        if (flag == "--runs") {
+            ok = (in >> options.runs) && options.runs > 0;
+        } else if (flag == "--size") {
+            char by = 0;
+            ok = (in >> options.numRows >> by >> options.numCols) && by == 'x'
+                 && options.numRows > 0 && options.numCols > 0;
+        } else if (flag == "--densities") {
+            ok = parseDensities(value, options.densities);
+        } else if (flag == "--seed") {
+            ok = bool(in >> options.seed);
+        } else if (flag == "--max-generations") {
+            ok = (in >> options.maxGenerations) && options.maxGenerations >= 0;
+        } else if (flag == "--engine") {
+            ok = LifeEngine::nameToType(value, options.type);
+        } else if (flag == "--threads") {
+            ok = (in >> options.numThreads) && options.numThreads >= 0;
+        } else if (flag == "--rule") {
+            ok = LifeRule::parse(value, options.rule);
+        } else if (flag == "--csv") {
+            options.csvFile = value;
+        } else if (flag == "--json") {
+            options.jsonFile = value;
+        } else {
+            usage("unknown option " + flag);
+        }
+        if (!ok) usage("bad value for " + flag + ": " + value);
+    }
+    if (options.wrap && (options.type == LifeEngine::Classic || options.type == LifeEngine::Plane)) {
+        usage("the " + LifeEngine::typeToName(options.type) + " engine can't wrap its edges");
+    }
+    if (options.type == LifeEngine::Plane && options.rule.bornFromNothing()) {
+        usage("an unbounded plane can't run " + options.rule.toString());
+    }
+}
+
+static bool parseDensities(const string& value, vector<double>& densities) {
+    densities.clear();
+    istringstream in(value);
+    string item;
+    while (getline(in, item, ',')) {
+        istringstream number(item);
+        double density;
+        if (!(number >> density) || density < 0 || density > 1) return false;
+        densities.push_back(density);
+    }
+    return !densities.empty();
+}
+
+/**
+ * An empty problem means the usage was asked for with --help, which
+ * isn't a failure.
+ */
+
+static void usage(const string& problem) {
+    if (!problem.empty()) cerr << "life-sweep: " << problem << endl;
+    cerr << "usage: life-sweep [--runs <n>] [--size <rows>x<cols>] [--densities <p,q,...>]" << endl;
+    cerr << "                  [--seed <n>] [--max-generations <n>] [--engine <name>]" << endl;
+    cerr << "                  [--threads <n>] [--wrap] [--rule <rule>] [--csv <file>]" << endl;
+    cerr << "                  [--json <file>] [--help]" << endl;
+    exit(problem.empty() ? 0 : 1);
+}
+
+static double now() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/**
+ * Runs are numbered density by density, so run r uses density number
+ * r / runs and seed + r.  The pool already keeps every core busy, so
+ * each colony is stepped on a single thread.
+ */
+
+static void runColony(void *data, int run) {
+    Sweep *sweep = (Sweep *) data;
+    const SweepOptions& options = *sweep->options;
+    RunResult& result = sweep->results[run];
+    result.seed = options.seed + run;
+    result.density = options.densities[run / options.runs];
+
+    LifeEngine *engine = LifeEngine::createLifeEngine(options.type, 1);
+    if (options.wrap) engine->setBoundary(LifeEngine::Toroidal);
+    engine->setRule(options.rule);
+    seedRandomColony(*engine, options.numRows, options.numCols, result.density, result.seed);
+    result.initialPopulation = engine->getPopulation();
+
+    LifeCycleDetector cycles;
+    result.settled = cycles.observe(*engine);
+    while (!result.settled && engine->getGeneration() < options.maxGenerations) {
+        engine->step();
+        result.settled = cycles.observe(*engine);
+    }
+    result.finalPopulation = engine->getPopulation();
+    result.lifetime = result.settled ? cycles.getCycleStart() : engine->getGeneration();
+    result.period = cycles.getPeriod();
+    delete engine;
+}
+
+static vector<DensitySummary> summarize(const SweepOptions& options,
+                                        const vector<RunResult>& results) {
+    vector<DensitySummary> summaries(options.densities.size());
+    for (size_t d = 0; d < summaries.size(); d++) {
+        DensitySummary& summary = summaries[d];
+        summary.runs = options.runs;
+        summary.settled = 0;
+        summary.extinct = 0;
+        summary.stillLifes = 0;
+        summary.totalLifetime = 0;
+        summary.totalFinalPopulation = 0;
+        summary.maxLifetime = 0;
+        for (int i = 0; i < options.runs; i++) {
+            const RunResult& result = results[d * options.runs + i];
+            if (result.settled) summary.settled++;
+            if (result.settled && result.finalPopulation == 0) summary.extinct++;
+            if (result.settled && result.finalPopulation > 0 && result.period == 1) summary.stillLifes++;
+            summary.totalLifetime += result.lifetime;
+            summary.totalFinalPopulation += result.finalPopulation;
+            summary.maxLifetime = max(summary.maxLifetime, result.lifetime);
+        }
+    }
+    return summaries;
+}
+
+static void reportSummary(const SweepOptions& options, const vector<RunResult>& results) {
+    vector<DensitySummary> summaries = summarize(options, results);
+    cout << "rule " << options.rule.toString() << endl;
+    cout << "density    runs  settled  extinct  still  mean life  max life  mean final pop" << endl;
+    for (size_t d = 0; d < summaries.size(); d++) {
+        const DensitySummary& summary = summaries[d];
+        cout << fixed << setprecision(3) << setw(7) << options.densities[d]
+             << setw(8) << summary.runs << setw(9) << summary.settled
+             << setw(9) << summary.extinct << setw(7) << summary.stillLifes
+             << setprecision(1) << setw(11) << summary.totalLifetime / summary.runs
+             << setw(10) << summary.maxLifetime
+             << setw(16) << summary.totalFinalPopulation / summary.runs << endl;
+    }
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+static void writeCSV(const string& filename, const vector<RunResult>& results) {
+    ofstream out(filename.c_str());
+    if (!out.is_open()) usage("can't write " + filename);
+    out << "run,seed,density,initial_population,final_population,lifetime,period,settled" << endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const RunResult& result = results[i];
+        out << i << ',' << result.seed << ',' << result.density << ','
+            << result.initialPopulation << ',' << result.finalPopulation << ','
+            << result.lifetime << ',' << result.period << ','
+            << (result.settled ? 1 : 0) << endl;
+    }
+}
+
+static void writeJSON(const string& filename, const SweepOptions& options,
+                      const vector<RunResult>& results) {
+    ofstream out(filename.c_str());
+    if (!out.is_open()) usage("can't write " + filename);
+    vector<DensitySummary> summaries = summarize(options, results);
+    out << "{" << endl;
+    out << "  \"rows\": " << options.numRows << "," << endl;
+    out << "  \"cols\": " << options.numCols << "," << endl;
+    out << "  \"engine\": \"" << LifeEngine::typeToName(options.type) << "\"," << endl;
+    out << "  \"wrap\": " << (options.wrap ? "true" : "false") << "," << endl;
+    out << "  \"rule\": \"" << options.rule.toString() << "\"," << endl;
+    out << "  \"seed\": " << options.seed << "," << endl;
+    out << "  \"max_generations\": " << options.maxGenerations << "," << endl;
+    out << "  \"densities\": [" << endl;
+    for (size_t d = 0; d < summaries.size(); d++) {
+        const DensitySummary& summary = summaries[d];
+        out << "    {\"density\": " << options.densities[d]
+            << ", \"runs\": " << summary.runs
+            << ", \"settled\": " << summary.settled
+            << ", \"extinct\": " << summary.extinct
+            << ", \"still_lifes\": " << summary.stillLifes
+            << ", \"mean_lifetime\": " << summary.totalLifetime / summary.runs
+            << ", \"max_lifetime\": " << summary.maxLifetime
+            << ", \"mean_final_population\": " << summary.totalFinalPopulation / summary.runs
+            << "}" << (d + 1 < summaries.size() ? "," : "") << endl;
+    }
+    out << "  ]" << endl;
+    out << "}" << endl;
+}
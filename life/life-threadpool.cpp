@@ -0,0 +1,159 @@
+/**
+ * File: life-threadpool.cpp
+ * -------------------------
+ * Implements the work-stealing thread pool on top of POSIX threads.
+ */
+
+#include <unistd.h>
+#include "life-threadpool.h"
+#include "error.h"
+using namespace std;
+
+ThreadPool::ThreadPool(int numThreads) {
+    if (numThreads <= 0) numThreads = processorCount();
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&batchReady, NULL);
+    pthread_cond_init(&batchDone, NULL);
+    batch = 0;
+    busy = 0;
+    shuttingDown = false;
+    fn = NULL;
+    data = NULL;
+    for (int i = 0; i < numThreads; i++) {
+        Worker *worker = new Worker;
+        worker->pool = this;
+        worker->index = i;
+        worker->first = 0;
+        worker->last = 0;
+        pthread_mutex_init(&worker->lock, NULL);
+        workers.push_back(worker);
+    }
+    for (int i = 1; i < numThreads; i++) { // workers[0] is whoever calls run
+        if (pthread_create(&workers[i]->thread, NULL, workerMain, workers[i]) != 0) {
+            shutDown(i);
+            error("ThreadPool could not start a worker thread.");
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    shutDown(int(workers.size()));
+}
+
+/**
+ * Stops and joins the first numStarted workers, counting workers[0],
+ * and frees everything the constructor made.  The constructor calls it
+ * too when a thread won't start, so the ones that did don't go on
+ * waiting for a pool that's gone.
+ */
+
+void ThreadPool::shutDown(int numStarted) {
+    pthread_mutex_lock(&lock);
+    shuttingDown = true;
+    pthread_cond_broadcast(&batchReady);
+    pthread_mutex_unlock(&lock);
+    for (int i = 0; i < int(workers.size()); i++) {
+        if (i > 0 && i < numStarted) pthread_join(workers[i]->thread, NULL);
+        pthread_mutex_destroy(&workers[i]->lock);
+        delete workers[i];
+    }
+    workers.clear();
+    pthread_cond_destroy(&batchDone);
+    pthread_cond_destroy(&batchReady);
+    pthread_mutex_destroy(&lock);
+}
+
+void ThreadPool::run(int numTasks, TaskFunction fn, void *data) {
+    if (numTasks <= 0) return;
+    int numWorkers = workers.size();
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < numWorkers; i++) {
+        Worker *worker = workers[i];
+        pthread_mutex_lock(&worker->lock);
+        worker->first = int((long long) numTasks * i / numWorkers);
+        worker->last = int((long long) numTasks * (i + 1) / numWorkers);
+        pthread_mutex_unlock(&worker->lock);
+    }
+    this->fn = fn;
+    this->data = data;
+    busy = numWorkers - 1;
+    batch++;
+    pthread_cond_broadcast(&batchReady);
+    pthread_mutex_unlock(&lock);
+
+    drain(workers[0]);
+
+    pthread_mutex_lock(&lock);
+    while (busy > 0) {
+        pthread_cond_wait(&batchDone, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+int ThreadPool::processorCount() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? int(count) : 1;
+}
+
+/**
+ * Every worker but the first parks here between batches.  The batch
+ * counter, rather than a flag, tells a worker that new work is ready,
+ * so a wakeup can never be mistaken for a batch it has already done.
+ */
+
+void *ThreadPool::workerMain(void *arg) {
+    Worker *self = (Worker *) arg;
+    ThreadPool *pool = self->pool;
+    long seen = 0;
+    while (true) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->batch == seen && !pool->shuttingDown) {
+            pthread_cond_wait(&pool->batchReady, &pool->lock);
+        }
+        if (pool->shuttingDown) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->batch;
+        pthread_mutex_unlock(&pool->lock);
+
+        pool->drain(self);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0) pthread_cond_signal(&pool->batchDone);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+void ThreadPool::drain(Worker *self) {
+    int task;
+    while (takeOwn(self, task) || steal(self, task)) {
+        fn(data, task);
+    }
+}
+
+bool ThreadPool::takeOwn(Worker *self, int& task) {
+    pthread_mutex_lock(&self->lock);
+    bool found = self->first < self->last;
+    if (found) task = self->first++;
+    pthread_mutex_unlock(&self->lock);
+    return found;
+}
+
+/**
+ * Steals from the back of the next non-empty range after our own, so
+ * the victim and the thief work from opposite ends and rarely collide.
+ */
+
+bool ThreadPool::steal(Worker *self, int& task) {
+    int numWorkers = workers.size();
+    for (int offset = 1; offset < numWorkers; offset++) {
+        Worker *victim = workers[(self->index + offset) % numWorkers];
+        pthread_mutex_lock(&victim->lock);
+        bool found = victim->first < victim->last;
+        if (found) task = --victim->last;
+        pthread_mutex_unlock(&victim->lock);
+        if (found) return true;
+    }
+    return false;
+}
@@ -0,0 +1,96 @@
+/**
+ * File: life-threadpool.h
+ * -----------------------
+ * Defines a small, persistent pool of worker threads for running a
+ * batch of independent tasks.  The StanfordCPPLib thread.h interface
+ * only offers fork and join, which would mean creating and destroying
+ * threads every generation; this pool starts its threads once and
+ * parks them between batches.
+ *
+ * Each batch is split into one contiguous range of task numbers per
+ * worker.  A worker takes tasks from the front of its own range, and
+ * once that runs dry it steals from the back of somebody else's, so
+ * a worker that lands on cheap tasks helps out with the expensive ones.
+ */
+
+#ifndef _life_threadpool_h_
+#define _life_threadpool_h_
+
+#include <vector>
+#include <pthread.h>
+
+class ThreadPool {
+public:
+
+/**
+ * Type: TaskFunction
+ * ------------------
+ * The function run for every task in a batch.  The data pointer is
+ * passed through untouched from run, and task is the task number.
+ */
+
+    typedef void (*TaskFunction)(void *data, int task);
+
+/**
+ * Starts a pool that runs batches on numThreads threads in total.
+ * The thread calling run is one of them, so numThreads - 1 workers
+ * are created.  Passing 0 asks for one thread per online processor.
+ */
+
+    ThreadPool(int numThreads);
+
+/**
+ * Stops and joins all of the worker threads.
+ */
+
+    ~ThreadPool();
+
+    int numThreads() const { return int(workers.size()); }
+
+/**
+ * Runs fn(data, task) for every task in [0, numTasks), spread across
+ * the pool, and returns once every one of them has finished.  Tasks
+ * must be independent of one another, since they run in no particular
+ * order.  run is not reentrant: only one batch may be in flight.
+ */
+
+    void run(int numTasks, TaskFunction fn, void *data);
+
+/**
+ * Returns the number of processors currently online, or 1 if the
+ * platform won't say.
+ */
+
+    static int processorCount();
+
+private:
+    struct Worker {
+        ThreadPool *pool;
+        int index;
+        pthread_t thread;
+        pthread_mutex_t lock;
+        int first;
+        int last;
+    };
+
+    std::vector<Worker *> workers;
+    pthread_mutex_t lock;
+    pthread_cond_t batchReady;
+    pthread_cond_t batchDone;
+    long batch;
+    int busy;
+    bool shuttingDown;
+    TaskFunction fn;
+    void *data;
+
+    static void *workerMain(void *arg);
+    void shutDown(int numStarted);
+    void drain(Worker *self);
+    bool takeOwn(Worker *self, int& task);
+    bool steal(Worker *self, int& task);
+
+    ThreadPool(const ThreadPool& original);
+    void operator=(const ThreadPool& rhs);
+};
+
+#endif
@@ -0,0 +1,28 @@
+/**
+ * File: life-tiled.cpp
+ * --------------------
+ * Implements the cache-blocked stepping engine.
+ */
+
+#include <algorithm>
+#include "life-tiled.h"
+using namespace std;
+
+/**
+ * The strips split the colony evenly rather than leaving a sliver at
+ * the right-hand edge, and a colony narrower than kStripCols is simply
+ * one strip.
+ */
+
+void TiledLifeEngine::step() {
+    fillBorder();
+    StepTally tally;
+    int numStrips = max((nCols + kStripCols - 1) / kStripCols, 1);
+    columnSums.resize(size_t(nCols) / numStrips + 3);
+    for (int strip = 0; strip < numStrips; strip++) {
+        int startCol = int((long long) nCols * strip / numStrips);
+        int endCol = int((long long) nCols * (strip + 1) / numStrips);
+        stepStrip(startCol, endCol, &columnSums[0], tally);
+    }
+    swapBuffers(tally);
+}
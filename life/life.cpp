@@ -15,60 +15,123 @@ using namespace std;
 #include "random.h"
 #include "vector.h"
 #include "grid.h"
-#include "life-constants.h"  // for kMaxAge
 #include "life-graphics.h"   // for class LifeDisplay
+#include "life-engine.h"     // for class LifeEngine
+#include "life-colony.h"     // for readColonyFile, seedRandomColony
+#include "life-cycles.h"     // for class LifeCycleDetector
+#include "life-record.h"     // for classes LifeRecorder, LifePlayer
 #include "gevents.h"
 
 
 static void welcome();
-static void setUp(LifeDisplay& display, Grid<int>& thisgeneration);
+static void setUp(LifeDisplay& display, LifeEngine& engine);
 int setSpeed();
 int speedConverter(string number);
-static void cellFlagger(Grid<int>& nextgeneration, Grid<int>& birthsanddeaths);
-static void lifeGenerator(Grid<int>& nextgeneration, Grid<int>& birthsanddeaths);
-static void updateDisplay(Grid<int>& thisgeneration, LifeDisplay& display);
-void runSimulation(Grid<int>& thisgeneration, LifeDisplay& display, int speed);
+static LifeEngine::EngineType chooseEngine();
+static int chooseThreads();
+static LifeEngine::Boundary chooseBoundary();
+static LifeRule chooseRule(LifeEngine::EngineType type);
+static bool chooseRecording(LifePlayer& player);
+static void chooseRecorder(const LifeEngine& engine, LifeRecorder& recorder);
+template <typename Colony>
+static void updateDisplay(const Colony& colony, LifeDisplay& display, Grid<int>& frame);
+static void reportCycle(const LifeEngine& engine, const LifeCycleDetector& cycles);
+static void waitForNextGeneration(int speed);
+void runSimulation(LifeEngine& engine, LifeDisplay& display, int speed, LifeRecorder& recorder);
+void replayRecording(LifePlayer& player, LifeDisplay& display, int speed);
 
 
 int main() {
     LifeDisplay display;
     display.setTitle("Game of Life");
     display.setDimensions(40, 60);
-    Grid<int> thisgeneration(40, 60);
     welcome();
-    setUp(display, thisgeneration);
+    LifePlayer player;
+    if (chooseRecording(player)) {
+        replayRecording(player, display, setSpeed());
+        return 0;
+    }
+    LifeEngine::EngineType type = chooseEngine();
+    int numThreads = (type == LifeEngine::Parallel) ? chooseThreads() : 0;
+    LifeEngine *engine = LifeEngine::createLifeEngine(type, numThreads);
+    if (type != LifeEngine::Classic && type != LifeEngine::Plane) {
+        engine->setBoundary(chooseBoundary());
+    }
+    engine->setRule(chooseRule(type));
+    setUp(display, *engine);
+    cout << "Running under rule " << engine->getRule().toString() << "." << endl;
+    LifeRecorder recorder;
+    chooseRecorder(*engine, recorder);
     int speed = setSpeed();
-    runSimulation(thisgeneration, display, speed);
+    runSimulation(*engine, display, speed, recorder);
+    recorder.close();
+    delete engine;
     
     return 0;
 }
 
-void runSimulation(Grid<int>& thisgeneration, LifeDisplay& display, int speed) {
-    int nrows = thisgeneration.numRows();
-    int ncols = thisgeneration.numCols();
-    while (true) {
-        if (speed == 4) {
-            cout << ("Hit [enter] to continue...");
-            cin.ignore();
+void runSimulation(LifeEngine& engine, LifeDisplay& display, int speed, LifeRecorder& recorder) {
+    Grid<int> frame(engine.numRows(), engine.numCols());// what's on screen now; setUp drew the first generation
+    for (int x = 0; x < engine.numRows(); x++) {
+        for (int y = 0; y < engine.numCols(); y++) {
+            frame[x][y] = engine.getAge(x, y);
         }
-        else if (speed == 3) {
-            pause(1000);
-        }
-        else if (speed == 2) {
-            pause(250);
-        }
-        else if (speed == 1) {
-            pause(0);
+    }
+    LifeCycleDetector cycles;
+    while (!cycles.observe(engine)) {
+        waitForNextGeneration(speed);
+        engine.step();
+        recorder.record(engine);
+        updateDisplay(engine, display, frame);
         }
-        Grid<int> birthsanddeaths(nrows, ncols);
-        Grid<int> nextgeneration(nrows, ncols);
-        nextgeneration = thisgeneration;
-        cellFlagger(nextgeneration, birthsanddeaths);
-        lifeGenerator(nextgeneration, birthsanddeaths);
-        thisgeneration = nextgeneration;
-        updateDisplay(thisgeneration, display);
+    reportCycle(engine, cycles);
+    }
+
+/**
+ * Plays a recording back from whichever generation the user picks to
+ * the end, at the same speeds as a live simulation.
+ */
+
+void replayRecording(LifePlayer& player, LifeDisplay& display, int speed) {
+    long first = player.getFirstGeneration();
+    long last = player.getLastGeneration();
+    cout << "The recording runs under rule " << player.getRule().toString()
+         << " from generation " << first << " to " << last << "." << endl;
+    while (true) {
+        cout << "Start at which generation? ";
+        long start = getInteger();
+        if (start >= first && start <= last) {
+            player.seek(start);
+            break;
         }
+        cout << "That generation isn't in the recording, try again." << endl;
     }
+    display.setDimensions(player.numRows(), player.numCols());
+    Grid<int> frame(player.numRows(), player.numCols());  // setDimensions left the window blank
+    updateDisplay(player, display, frame);
+    while (player.getGeneration() < last) {
+        waitForNextGeneration(speed);
+        player.step();
+        updateDisplay(player, display, frame);
+    }
+    cout << "That's the end of the recording, at generation " << last << "." << endl;
+}
+
+static void waitForNextGeneration(int speed) {
+    if (speed == 4) {
+        cout << ("Hit [enter] to continue...");
+        cin.ignore();
+    }
+    else if (speed == 3) {
+        pause(1000);
+    }
+    else if (speed == 2) {
+        pause(250);
+    }
+    else if (speed == 1) {
+        pause(0);
+    }
+}
 
 static void welcome() {
 	cout << "Welcome to the game of Life, a simulation of the lifecycle of a bacteria colony." << endl;
@@ -82,85 +145,46 @@ static void welcome() {
     cin.ignore();
 }
 
-static void setUp(LifeDisplay& display, Grid<int>& thisgeneration) {
-    cout << "You can start your colony with random cells or read from a prepared file." << endl;
+static void setUp(LifeDisplay& display, LifeEngine& engine) {
+    cout << "You can start your colony with random cells or read from a prepared file" << endl;
+    cout << "(either a colony file or an RLE pattern)." << endl;
     cout << ("Enter name of colony file (or RETURN to seed randomly): ");
     string setupmessage = getLine();
     if (setupmessage == "") {
         int nrows = randomInteger(40, 60);
         int ncols = randomInteger(40, 60);
-        thisgeneration.resize(nrows, ncols);
+        int seed = randomInteger(1, 1000000);
+        cout << "Random colony " << nrows << "x" << ncols << ", seed " << seed
+             << " (life-bench and life-sweep can replay it)." << endl;
+        seedRandomColony(engine, nrows, ncols, 0.5, seed);
         display.setTitle("Random Colony"); //sets up window and grid for random game
         display.setDimensions(nrows, ncols);
         for (int x = 0; x < nrows; x++) {
             for (int y = 0; y < ncols; y++) {
-                bool life = randomChance(0.5);
-                if (life == true) {
-                    int cell = randomInteger(1, kMaxAge);
-                    thisgeneration.set(x, y, cell);
+                int cell = engine.getAge(x, y);
+                if (cell > 0) {
                     display.drawCellAt(x, y, cell);
                 }
-                else if (life == false) {
-                    thisgeneration.set(x, y, 0);
-                }
             }
         }
     }
-    else if (setupmessage != "") { 
-        ifstream inp;
-        inp.open(setupmessage.c_str());
-        if (inp.is_open() == true) {
-            if (inp.fail()) { error("Could not open file");
-                cout << "Try again..." << endl;
-                inp.clear();
-                setUp(display, thisgeneration);
-            }
-            string row;
-            int linecount = 0;
-            int size = 0;
-            Vector<string> filereadout;
-            while (getline(inp, row)) {
-                char dash = row.find("-");
-                if (dash == string::npos) {
-                    inp.ignore();
-                }
-                else if (dash != string::npos) {
-                    filereadout.push_back(row);
-                    size = row.size();
-                    linecount++;
-                }
-                
-            }
-            int nrows = linecount;
-            int ncols = size;
-            thisgeneration.resize(nrows, ncols);
-            display.setTitle(setupmessage.c_str()); //sets up window and grid for game from file
-            display.setDimensions(nrows, ncols);
-            for (int x = 0; x < nrows; x++) {
-                string lines = filereadout.get(x);
-                for (int y = 0; y < lines.size(); y++) {
-                    char cells = lines[y];
-                    if (cells == 'X') {
-                        thisgeneration.set(x, y, 5);
-                        display.drawCellAt(x, y, 5);
-                    }
-                    else if (cells != 'X') {
-                        thisgeneration.set(x, y, 0);
-                    }
+    else if (readColonyFile(setupmessage, engine)) {
+        int nrows = engine.numRows();
+        int ncols = engine.numCols();
+        display.setTitle(setupmessage.c_str()); //sets up window and grid for game from file
+        display.setDimensions(nrows, ncols);
+        for (int x = 0; x < nrows; x++) {
+            for (int y = 0; y < ncols; y++) {
+                int cell = engine.getAge(x, y);
+                if (cell > 0) {
+                    display.drawCellAt(x, y, cell);
                 }
             }
         }
-
-        
-        else if (inp.is_open() == false) {
-            cout << "That file isn't in the directory, please try again." << endl;
-            setUp(display, thisgeneration);
-        }
-        else {
-            cout << "Fuck a duck... whats happening?" << endl;
-            setUp(display, thisgeneration);
-        }
-        
+    }
+    else {
+        cout << "That file isn't in the directory, please try again." << endl;
+        setUp(display, engine);
     }
 }
 
@@ -185,114 +209,133 @@ int speedConverter(string number) {
     return speed;
 }
 
-static void cellFlagger(Grid<int>& nextgeneration, Grid<int>& birthsanddeaths) {
-    int count;
-    int nrows = nextgeneration.numRows();
-    int ncols = nextgeneration.numCols();
-    for (int x = 0; x < nrows; x++) {
-        for (int y = 0; y < ncols; y++) {// counts through the cells around the cell
-                count = 0;
-                if (nextgeneration.inBounds(x + 1, y) == true) {
-                    int check = nextgeneration[x + 1][y];
-                    if (check >= 1) {
-                        count++;
-                    }
-                }
-                if (nextgeneration.inBounds(x - 1, y) == true) {
-                    int check = nextgeneration[x - 1][y];
-                    if (check >= 1) {
-                        count++;
-                    }
-                }
-                if (nextgeneration.inBounds(x, y + 1) == true) {
-                    int check = nextgeneration[x][y + 1];
-                    if (check >= 1) {
-                        count++;
-                    }
-                }
-                if (nextgeneration.inBounds(x, y - 1) == true) {
-                    int check = nextgeneration[x][y - 1];
-                    if (check >= 1) {
-                        count++;
-                    }
-                }
-                if (nextgeneration.inBounds(x - 1, y - 1) == true) {
-                    int check = nextgeneration[x - 1][y - 1];
-                    if (check >= 1) {
-                        count++;
-                    }
-                }
-                if (nextgeneration.inBounds(x + 1, y - 1) == true) {
-                    int check = nextgeneration[x + 1][y - 1];
-                    if (check >= 1) {
-                        count++;
-                    }
-                }
-                if (nextgeneration.inBounds(x + 1, y + 1) == true) {
-                    int check = nextgeneration[x + 1][y + 1];
-                    if (check >= 1) {
-                        count++;
-                    }
-                }
-                if (nextgeneration.inBounds(x - 1, y + 1) == true) {
-                    int check = nextgeneration[x - 1][y + 1];
-                    if (check >= 1) {
-                        count++;
-                    }
-                }
-            if (count != 2 && count != 3) {// marks cells for death
-                birthsanddeaths.set(x, y, -3);
-            }
-            if (count == 3) {// marks squares for new cells
-                birthsanddeaths.set(x, y, 3);
-                }
-          }
+static LifeEngine::EngineType chooseEngine() {
+    cout << "You choose how each generation is computed." << endl;
+    cout << "\t1 = Classic, one cell at a time." << endl;
+    cout << "\t2 = Bitboard, 64 cells at a time." << endl;
+    cout << "\t3 = Double-buffered, one pass per generation with no copying." << endl;
+    cout << "\t4 = Parallel, bands of rows stepped on several threads at once." << endl;
+    cout << "\t5 = Sparse, only the regions that are still changing." << endl;
+    cout << "\t6 = Plane, an unbounded plane that grows as the colony spreads." << endl;
+    cout << "\t7 = Tiled, running column sums over cache-sized strips." << endl;
+    while (true) {
+        cout << "your choice: ";
+        int choice = getInteger();
+        if (choice == 1) return LifeEngine::Classic;
+        if (choice == 2) return LifeEngine::Bitboard;
+        if (choice == 3) return LifeEngine::DoubleBuffered;
+        if (choice == 4) return LifeEngine::Parallel;
+        if (choice == 5) return LifeEngine::Sparse;
+        if (choice == 6) return LifeEngine::Plane;
+        if (choice == 7) return LifeEngine::Tiled;
+        cout << "That isn't a valid integer, try again." << endl;
     }
 }
 
-static void lifeGenerator(Grid<int>& nextgeneration, Grid<int>& birthsanddeaths) {
-    int nrows = nextgeneration.numRows();
-    int ncols = nextgeneration.numCols();
-    for (int turn = 1; turn < 4; turn++) {
-        for (int x = 0; x < nrows; x++) {
-            for (int y = 0; y < ncols; y++) {
-                if (turn == 1) {// deletes the cells that are marked by cellflagger to die
-                    int dead = birthsanddeaths.get(x, y);
-                    if (dead == -3) {
-                        nextgeneration.set(x, y, 0);
-                    }
-                }
-                else if (turn == 2) {// processes the age of the ones that remain
-                    int live = nextgeneration.get(x, y);
-                    if (live > 0 && live < kMaxAge) {
-                        live++;
-                        nextgeneration.set(x, y, live);
-                    }
-                }
-                else if (turn == 3) {// creates new cells on squares marked by cellflagger
-                    int born = birthsanddeaths.get(x, y);
-                    if (born == 3) { if (nextgeneration[x][y] == 0) {
-                        nextgeneration.set(x, y, 1);
-                        }
-                    }
-                }
-            }
+static int chooseThreads() {
+    while (true) {
+        cout << "How many threads (0 = one per processor)? ";
+        int numThreads = getInteger();
+        if (numThreads >= 0) return numThreads;
+        cout << "That isn't a valid integer, try again." << endl;
+    }
+}
+
+static LifeEngine::Boundary chooseBoundary() {
+    while (true) {
+        cout << "Should the edges wrap around (y/n)? ";
+        string answer = toLowerCase(trim(getLine()));
+        if (startsWith(answer, "y")) return LifeEngine::Toroidal;
+        if (startsWith(answer, "n")) return LifeEngine::DeadEdges;
+        cout << "Please answer y or n." << endl;
+    }
+}
+
+/**
+ * An RLE file that names a rule of its own overrides this choice once
+ * it's loaded.
+ */
+
+static LifeRule chooseRule(LifeEngine::EngineType type) {
+    while (true) {
+        cout << "Enter a rule such as B36/S23 or HighLife (RETURN for Conway's B3/S23): ";
+        string answer = trim(getLine());
+        LifeRule rule;
+        if (answer == "") return rule;
+        if (!LifeRule::parse(answer, rule)) {
+            cout << "That isn't a rule I know, try again." << endl;
+        } else if (type == LifeEngine::Plane && rule.bornFromNothing()) {
+            cout << "The plane can't hold a rule with births in empty space, try again." << endl;
+        } else {
+            return rule;
         }
     }
 }
 
-static void updateDisplay(Grid<int>& thisgeneration, LifeDisplay& display) {
-    int nrows = thisgeneration.numRows();
-    int ncols = thisgeneration.numCols();
-        display.setDimensions(nrows, ncols);
-        for (int x = 0; x < nrows; x++) {
-            for (int y = 0; y < ncols; y++) {
-                if (thisgeneration[x][y] > 0) {
-                    int cell = thisgeneration[x][y];
-                    display.drawCellAt(x, y, cell);
-            }
+/**
+ * A recording knows its own dimensions and rule, so replaying one skips
+ * every other question about how to set up the colony.
+ */
+
+static bool chooseRecording(LifePlayer& player) {
+    while (true) {
+        cout << "Enter name of a recording to replay (RETURN to start a new colony): ";
+        string filename = trim(getLine());
+        if (filename == "") return false;
+        if (player.open(filename)) {
+            return true;
         }
+        cout << "That isn't a recording I can open, try again." << endl;
+    }
+}
 
+static void chooseRecorder(const LifeEngine& engine, LifeRecorder& recorder) {
+    while (true) {
+        cout << "Enter a file to record this run to (RETURN for none): ";
+        string filename = trim(getLine());
+        if (filename == "") return;
+        if (recorder.open(filename, engine)) {
+            cout << "Recording to " << filename << "." << endl;
+            return;
+        }
+        cout << "That file can't be created, try again." << endl;
     }
 }
 
+/**
+ * Once the colony repeats itself, nothing new will ever happen, so the
+ * simulation stops and says why.
+ */
+
+static void reportCycle(const LifeEngine& engine, const LifeCycleDetector& cycles) {
+    if (engine.getPopulation() == 0) {
+        cout << "The colony died out at generation " << cycles.getCycleStart() << "." << endl;
+    } else if (cycles.getPeriod() == 1) {
+        cout << "The colony settled into a still life at generation " << cycles.getCycleStart() << "." << endl;
+    } else {
+        cout << "The colony has repeated itself every " << cycles.getPeriod()
+             << " generations since generation " << cycles.getCycleStart() << "." << endl;
+    }
+}
+
+/**
+ * Redraws only the cells whose age differs from what's on screen, as
+ * recorded in frame, and updates frame to match.  The colony is either
+ * a LifeEngine or a LifePlayer.  Dead cells are drawn
+ * in white, which erases them, so the window never has to be cleared.
+ */
+
+template <typename Colony>
+static void updateDisplay(const Colony& colony, LifeDisplay& display, Grid<int>& frame) {
+    int nrows = colony.numRows();
+    int ncols = colony.numCols();
+    for (int x = 0; x < nrows; x++) {
+        for (int y = 0; y < ncols; y++) {
+            int cell = colony.getAge(x, y);
+            if (cell != frame[x][y]) {
+                display.drawCellAt(x, y, cell);
+                frame[x][y] = cell;
+            }
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * File: compact-graph.cpp
+ * -----------------------
+ * Implements the CompactGraph class.
+ */
+
+#include <algorithm>
+#include <utility>
+#include "compact-graph.h"
+#include "foreach.h"
+
+using namespace std;
+
+CompactGraph::CompactGraph() {
+    costPerPixel = HUGE_VAL;
+    offsets.assign(1, 0);
+    pointAtOwnArrays();
+}
+
+/**
+ * A copy of a view refers to the same arrays as the original, while a
+ * copy of a built graph gets arrays of its own.
+ */
+
+CompactGraph::CompactGraph(const CompactGraph& other) {
+    *this = other;
+}
+
+CompactGraph& CompactGraph::operator=(const CompactGraph& other) {
+    if (this == &other) return *this;
+    offsets = other.offsets;
+    targets = other.targets;
+    costs = other.costs;
+    xs = other.xs;
+    ys = other.ys;
+    costPerPixel = other.costPerPixel;
+    if (!other.viewing) {
+        pointAtOwnArrays();
+    } else {
+        view(other.nodeCount, other.offsetData, other.targetData, other.costData,
+             other.xData, other.yData, other.costPerPixel);
+    }
+    return *this;
+}
+
+void CompactGraph::build(const Vector<Node *>& nodes) {
+    int numNodes = nodes.size();
+    offsets.assign(numNodes + 1, 0);
+    for (int i = 0; i < numNodes; i++) {
+        offsets[i + 1] = offsets[i] + nodes[i]->arcs.size();
+    }
+    targets.resize(offsets[numNodes]);
+    costs.resize(offsets[numNodes]);
+    xs.resize(numNodes);
+    ys.resize(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        xs[i] = nodes[i]->loc.getX();
+        ys[i] = nodes[i]->loc.getY();
+    }
+    pointAtOwnArrays();
+    costPerPixel = HUGE_VAL;
+    vector<pair<int, double> > out;
+    for (int i = 0; i < numNodes; i++) {
+        out.clear();
+        foreach (Arc *arc in nodes[i]->arcs) {
+            out.push_back(make_pair(arc->finish->index, arc->cost));
+        }
+        sort(out.begin(), out.end());
+        for (size_t k = 0; k < out.size(); k++) {
+            targets[offsets[i] + k] = out[k].first;
+            costs[offsets[i] + k] = out[k].second;
+            double length = distance(i, out[k].first);
+            if (length > 0) costPerPixel = min(costPerPixel, out[k].second / length);
+        }
+    }
+}
+
+void CompactGraph::view(int numNodes, const int *offsets, const int *targets, const double *costs,
+                        const double *xs, const double *ys, double costPerPixel) {
+    this->offsets.clear();
+    this->targets.clear();
+    this->costs.clear();
+    this->xs.clear();
+    this->ys.clear();
+    viewing = true;
+    nodeCount = numNodes;
+    offsetData = offsets;
+    targetData = targets;
+    costData = costs;
+    xData = xs;
+    yData = ys;
+    this->costPerPixel = costPerPixel;
+}
+
+/**
+ * Vectors that are empty may have no array at all, so the pointers are
+ * taken with begin() only when there's something in them.
+ */
+
+void CompactGraph::pointAtOwnArrays() {
+    viewing = false;
+    nodeCount = int(offsets.size()) - 1;
+    offsetData = &offsets[0];
+    targetData = targets.empty() ? NULL : &targets[0];
+    costData = costs.empty() ? NULL : &costs[0];
+    xData = xs.empty() ? NULL : &xs[0];
+    yData = ys.empty() ? NULL : &ys[0];
+}
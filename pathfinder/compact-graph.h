@@ -0,0 +1,130 @@
+/**
+ * File: compact-graph.h
+ * ---------------------
+ * Defines a frozen copy of a graph's arcs in compressed sparse row
+ * form.  Nodes are numbered 0 to numNodes() - 1, and the arcs out of
+ * node i are the slots arcsBegin(i) up to arcsEnd(i) of two flat
+ * arrays, one of target node numbers and one of costs, so walking a
+ * node's arcs reads a few consecutive cache lines rather than chasing
+ * pointers through a tree of heap-allocated Arcs.  Each node's screen
+ * location is kept alongside, for searches that aim at a destination.
+ *
+ * The arrays are usually the graph's own, filled in by build, but view
+ * can point it at arrays kept somewhere else instead, such as in a
+ * snapshot file mapped into memory, without copying them.
+ */
+
+#ifndef _compact_graph_h
+#define _compact_graph_h
+
+#include <cmath>
+#include <vector>
+#include "graphtypes.h"
+#include "vector.h"
+
+class CompactGraph {
+public:
+    CompactGraph();
+    CompactGraph(const CompactGraph& other);
+    CompactGraph& operator=(const CompactGraph& other);
+
+/**
+ * Method: build
+ * Usage: compact.build(nodes);
+ * ----------------------------
+ * Replaces the contents with the arcs of the given nodes, each of
+ * which must already be numbered with its position in nodes.  The arcs
+ * out of each node are stored in order of target, and later changes to
+ * the nodes' arc sets aren't seen until the next build.
+ */
+
+    void build(const Vector<Node *>& nodes);
+
+/**
+ * Method: view
+ * Usage: compact.view(numNodes, offsets, targets, costs, xs, ys, costPerPixel);
+ * ----------------------------------------------------------------------------
+ * Makes this a graph of the arcs in the given arrays, laid out just as
+ * build lays out its own, without copying them.  The arrays must stay
+ * where they are for as long as the graph refers to them, which is
+ * until the next build or view.
+ */
+
+    void view(int numNodes, const int *offsets, const int *targets, const double *costs,
+              const double *xs, const double *ys, double costPerPixel);
+
+    int numNodes() const { return nodeCount; }
+    int numArcs() const { return offsetData[nodeCount]; }
+
+/**
+ * Methods: arcsBegin, arcsEnd, target, cost
+ * Usage: for (int a = compact.arcsBegin(node); a < compact.arcsEnd(node); a++) {
+ *            ... compact.target(a) ... compact.cost(a) ...
+ *        }
+ * -------------------------------------------------------------------------------
+ * The arcs out of node occupy the slots [arcsBegin(node), arcsEnd(node)).
+ */
+
+    int arcsBegin(int node) const { return offsetData[node]; }
+    int arcsEnd(int node) const { return offsetData[node + 1]; }
+    int target(int arc) const { return targetData[arc]; }
+    double cost(int arc) const { return costData[arc]; }
+
+/**
+ * Method: distance
+ * Usage: double pixels = compact.distance(from, to);
+ * --------------------------------------------------
+ * Returns the straight-line distance, in pixels, between two nodes.
+ */
+
+    double distance(int from, int to) const {
+        double dx = xData[from] - xData[to];
+        double dy = yData[from] - yData[to];
+        return sqrt(dx * dx + dy * dy);
+    }
+
+/**
+ * Method: maxCostPerPixel
+ * Usage: double scale = compact.maxCostPerPixel();
+ * ------------------------------------------------
+ * Returns the smallest ratio of cost to length over all of the arcs
+ * that have any length, or HUGE_VAL if none do.  No route can cost
+ * less than this many times the straight-line distance it covers, so
+ * any smaller scale makes an admissible heuristic for A*.
+ */
+
+    double maxCostPerPixel() const { return costPerPixel; }
+
+/**
+ * Methods: offsetArray, targetArray, costArray, xArray, yArray
+ * Usage: const int *offsets = compact.offsetArray();
+ * --------------------------------------------------
+ * Return the arrays themselves, for writing them out whole.
+ */
+
+    const int *offsetArray() const { return offsetData; }
+    const int *targetArray() const { return targetData; }
+    const double *costArray() const { return costData; }
+    const double *xArray() const { return xData; }
+    const double *yArray() const { return yData; }
+
+private:
+    bool viewing;                 // whether the arrays are kept elsewhere
+    int nodeCount;
+    const int *offsetData;        // numNodes() + 1 entries; node i's arcs start at offsetData[i]
+    const int *targetData;
+    const double *costData;
+    const double *xData;          // screen location of each node
+    const double *yData;
+    double costPerPixel;
+
+    std::vector<int> offsets;     // the arrays build fills in, which the pointers
+    std::vector<int> targets;     // above point into unless the graph is a view
+    std::vector<double> costs;
+    std::vector<double> xs;
+    std::vector<double> ys;
+
+    void pointAtOwnArrays();
+};
+
+#endif
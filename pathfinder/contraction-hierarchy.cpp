@@ -0,0 +1,406 @@
+/**
+ * File: contraction-hierarchy.cpp
+ * -------------------------------
+ * Implements the ContractionHierarchy class.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "contraction-hierarchy.h"
+#include "pqueue-indexed.h"
+
+using namespace std;
+
+static const char kMagic[] = "PFCH";
+static const int kMagicLength = 4;
+static const int kVersion = 1;
+static const double kUnreached = 1e300;
+
+/**
+ * A witness search gives up after settling this many nodes.  Giving up
+ * early only means the occasional shortcut that wasn't needed.
+ */
+
+static const int kWitnessLimit = 500;
+
+/**
+ * Class: Contractor
+ * -----------------
+ * Holds the graph while it's being contracted.  Each uncontracted
+ * node's arcs to the other uncontracted nodes, shortcuts included, are
+ * kept in an unsorted list, with any parallel arcs merged into the
+ * cheapest.  When a node is contracted, those arcs are exactly its
+ * upward arcs, so they're copied out into up and the node is removed
+ * from its neighbors' lists.
+ */
+
+class Contractor {
+public:
+    struct Edge {
+        int to;
+        double cost;
+        int middle;
+    };
+
+    vector<vector<Edge> > adj;
+    vector<vector<Edge> > up;
+    vector<int> rank;
+
+    Contractor(const CompactGraph& graph);
+    void run();
+
+private:
+    vector<int> level;            // how many contractions deep each node's arcs reach
+    vector<int> deletedNeighbors;
+    vector<double> witnessDist;
+    vector<int> witnessTouched;
+    IndexedPQueue witnessQueue;
+
+    double priority(int node);
+    int shortcutsFor(int node, bool add);
+    void witnessSearch(int from, int skip, double limit);
+    void addEdge(int from, int to, double cost, int middle);
+    void contract(int node);
+};
+
+Contractor::Contractor(const CompactGraph& graph) {
+    int numNodes = graph.numNodes();
+    adj.resize(numNodes);
+    up.resize(numNodes);
+    rank.assign(numNodes, -1);
+    level.assign(numNodes, 0);
+    deletedNeighbors.assign(numNodes, 0);
+    witnessDist.assign(numNodes, kUnreached);
+    witnessQueue.reset(numNodes);
+    for (int node = 0; node < numNodes; node++) {
+        for (int arc = graph.arcsBegin(node); arc < graph.arcsEnd(node); arc++) {
+            if (graph.target(arc) != node) addEdge(node, graph.target(arc), graph.cost(arc), -1);
+        }
+    }
+}
+
+/**
+ * The order is chosen greedily, contracting next whichever node would
+ * add the fewest shortcuts for the arcs it removes, with a nudge
+ * towards nodes whose neighbors haven't lost many arcs yet and whose
+ * own arcs don't already reach deep into the hierarchy, which spreads
+ * the contractions evenly over the map.  A node's priority only
+ * changes when its neighbors are contracted, so rather than keep every
+ * priority up to date, each one is checked as it comes off the queue
+ * and put back if it has grown past the next one's.
+ */
+
+void Contractor::run() {
+    int numNodes = int(adj.size());
+    IndexedPQueue order(numNodes);
+    int nextRank = 0;
+    for (int node = 0; node < numNodes; node++) {
+        order.enqueue(node, priority(node));
+    }
+    while (!order.isEmpty()) {
+        int node = order.extractMin();
+        double current = priority(node);
+        if (!order.isEmpty() && current > order.peekPriority()) {
+            order.enqueue(node, current);
+            continue;
+        }
+        contract(node);
+        rank[node] = nextRank++;
+    }
+}
+
+double Contractor::priority(int node) {
+    int edgeDifference = shortcutsFor(node, false) - int(adj[node].size());
+    return 2 * edgeDifference + deletedNeighbors[node] + level[node];
+}
+
+/**
+ * A shortcut between two neighbors of node is needed unless a witness
+ * search, which avoids node, finds some other route between them that
+ * costs no more than the two arcs through it.
+ */
+
+int Contractor::shortcutsFor(int node, bool add) {
+    vector<Edge> neighbors = adj[node];
+    int count = 0;
+    for (size_t i = 0; i + 1 < neighbors.size(); i++) {
+        double limit = 0;
+        for (size_t j = i + 1; j < neighbors.size(); j++) {
+            limit = max(limit, neighbors[i].cost + neighbors[j].cost);
+        }
+        witnessSearch(neighbors[i].to, node, limit);
+        for (size_t j = i + 1; j < neighbors.size(); j++) {
+            double through = neighbors[i].cost + neighbors[j].cost;
+            if (witnessDist[neighbors[j].to] > through) {
+                count++;
+                if (add) addEdge(neighbors[i].to, neighbors[j].to, through, node);
+            }
+        }
+    }
+    return count;
+}
+
+void Contractor::witnessSearch(int from, int skip, double limit) {
+    for (size_t i = 0; i < witnessTouched.size(); i++) {
+        witnessDist[witnessTouched[i]] = kUnreached;
+    }
+    witnessTouched.clear();
+    witnessQueue.clear();
+    witnessDist[from] = 0;
+    witnessTouched.push_back(from);
+    witnessQueue.enqueue(from, 0);
+    int settled = 0;
+    while (!witnessQueue.isEmpty() && settled < kWitnessLimit) {
+        if (witnessQueue.peekPriority() > limit) break;
+        int node = witnessQueue.extractMin();
+        settled++;
+        for (size_t i = 0; i < adj[node].size(); i++) {
+            const Edge& edge = adj[node][i];
+            if (edge.to == skip) continue;
+            double distance = witnessDist[node] + edge.cost;
+            if (distance < witnessDist[edge.to]) {
+                if (witnessDist[edge.to] == kUnreached) witnessTouched.push_back(edge.to);
+                witnessDist[edge.to] = distance;
+                witnessQueue.enqueue(edge.to, distance);
+            }
+        }
+    }
+}
+
+/**
+ * Adds an arc both ways between from and to, or lowers the cost of the
+ * one that's already there.
+ */
+
+void Contractor::addEdge(int from, int to, double cost, int middle) {
+    for (size_t i = 0; i < adj[from].size(); i++) {
+        Edge& edge = adj[from][i];
+        if (edge.to == to) {
+            if (cost < edge.cost) {
+                edge.cost = cost;
+                edge.middle = middle;
+                for (size_t j = 0; j < adj[to].size(); j++) {
+                    if (adj[to][j].to == from) {
+                        adj[to][j].cost = cost;
+                        adj[to][j].middle = middle;
+                    }
+                }
+            }
+            return;
+        }
+    }
+    Edge there = { to, cost, middle };
+    Edge back = { from, cost, middle };
+    adj[from].push_back(there);
+    adj[to].push_back(back);
+}
+
+void Contractor::contract(int node) {
+    shortcutsFor(node, true);
+    up[node] = adj[node];
+    for (size_t i = 0; i < up[node].size(); i++) {
+        int neighbor = up[node][i].to;
+        vector<Edge>& edges = adj[neighbor];
+        for (size_t j = 0; j < edges.size(); j++) {
+            if (edges[j].to == node) {
+                edges[j] = edges.back();
+                edges.pop_back();
+                break;
+            }
+        }
+        deletedNeighbors[neighbor]++;
+        level[neighbor] = max(level[neighbor], level[node] + 1);
+    }
+    vector<Edge>().swap(adj[node]);
+}
+
+ContractionHierarchy::ContractionHierarchy() {
+    graphFingerprint = 0;
+}
+
+void ContractionHierarchy::build(const CompactGraph& graph) {
+    Contractor contractor(graph);
+    contractor.run();
+    int numNodes = graph.numNodes();
+    ranks = contractor.rank;
+    offsets.assign(numNodes + 1, 0);
+    for (int node = 0; node < numNodes; node++) {
+        offsets[node + 1] = offsets[node] + int(contractor.up[node].size());
+    }
+    targets.resize(offsets[numNodes]);
+    middles.resize(offsets[numNodes]);
+    costs.resize(offsets[numNodes]);
+    for (int node = 0; node < numNodes; node++) {
+        const vector<Contractor::Edge>& edges = contractor.up[node];
+        for (size_t i = 0; i < edges.size(); i++) {
+            targets[offsets[node] + i] = edges[i].to;
+            middles[offsets[node] + i] = edges[i].middle;
+            costs[offsets[node] + i] = edges[i].cost;
+        }
+    }
+    graphFingerprint = fingerprint(graph);
+}
+
+void ContractionHierarchy::clear() {
+    ranks.clear();
+    offsets.clear();
+    targets.clear();
+    middles.clear();
+    costs.clear();
+    graphFingerprint = 0;
+}
+
+/**
+ * An arc between two nodes is stored only with the lower ranked of
+ * them.
+ */
+
+int ContractionHierarchy::findArc(int from, int to) const {
+    if (ranks[from] > ranks[to]) swap(from, to);
+    for (int arc = arcsBegin(from); arc < arcsEnd(from); arc++) {
+        if (targets[arc] == to) return arc;
+    }
+    return -1;
+}
+
+/**
+ * The node a shortcut skips was contracted before either end, so both
+ * halves of the shortcut are upward arcs out of it.
+ */
+
+void ContractionHierarchy::unpack(int from, int to, vector<int>& path) const {
+    int arc = findArc(from, to);
+    int middle = (arc == -1) ? -1 : middles[arc];
+    if (middle == -1) {
+        path.push_back(to);
+    } else {
+        unpack(from, middle, path);
+        unpack(middle, to, path);
+    }
+}
+
+/**
+ * FNV-1a, over every node's arcs in order.
+ */
+
+unsigned long long ContractionHierarchy::fingerprint(const CompactGraph& graph) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (int node = 0; node < graph.numNodes(); node++) {
+        for (int arc = graph.arcsBegin(node); arc <= graph.arcsEnd(node); arc++) {
+            unsigned char bytes[sizeof(int) + sizeof(double)];
+            int target = (arc < graph.arcsEnd(node)) ? graph.target(arc) : -1;
+            double cost = (arc < graph.arcsEnd(node)) ? graph.cost(arc) : 0;
+            memcpy(bytes, &target, sizeof(int));
+            memcpy(bytes + sizeof(int), &cost, sizeof(double));
+            for (size_t i = 0; i < sizeof(bytes); i++) {
+                hash = (hash ^ bytes[i]) * 1099511628211ULL;
+            }
+        }
+    }
+    return hash;
+}
+
+template <typename T>
+static void writeArray(ofstream& out, const vector<T>& values) {
+    if (!values.empty()) out.write((const char *) &values[0], values.size() * sizeof(T));
+}
+
+template <typename T>
+static bool readArray(ifstream& input, vector<T>& values, int count) {
+    values.resize(count);
+    return count == 0 || input.read((char *) &values[0], count * sizeof(T));
+}
+
+/**
+ * The hierarchy is written under another name and then renamed, so a
+ * save that's cut short never leaves half a file where load looks.
+ */
+
+bool ContractionHierarchy::save(const string& filename) const {
+    string temporary = filename + ".tmp";
+    ofstream out(temporary.c_str(), ios::binary);
+    if (!out) return false;
+    int header[3] = { kVersion, numNodes(), numArcs() };
+    out.write(kMagic, kMagicLength);
+    out.write((const char *) header, sizeof(header));
+    out.write((const char *) &graphFingerprint, sizeof(graphFingerprint));
+    writeArray(out, ranks);
+    writeArray(out, offsets);
+    writeArray(out, targets);
+    writeArray(out, middles);
+    writeArray(out, costs);
+    out.close();
+    if (out.fail() || rename(temporary.c_str(), filename.c_str()) != 0) {
+        remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * The counts in the header must account for the rest of the file
+ * exactly before any array is made to hold what they promise, and the
+ * arrays are checked once they're read, so a damaged file can't ask
+ * for more memory than it has data, send a search off the end of an
+ * array or unpack into a loop.
+ */
+
+bool ContractionHierarchy::load(const string& filename, const CompactGraph& graph) {
+    clear();
+    ifstream input(filename.c_str(), ios::binary);
+    char magic[kMagicLength];
+    int header[3];
+    unsigned long long hash;
+    if (!input.read(magic, kMagicLength) || memcmp(magic, kMagic, kMagicLength) != 0
+        || !input.read((char *) header, sizeof(header))
+        || !input.read((char *) &hash, sizeof(hash))) {
+        return false;
+    }
+    int numNodes = header[1];
+    int numArcs = header[2];
+    if (header[0] != kVersion || numNodes != graph.numNodes() || numArcs < 0
+        || hash != fingerprint(graph)) {
+        return false;
+    }
+    streamoff start = input.tellg();
+    input.seekg(0, ios::end);
+    streamoff remaining = input.tellg() - start;
+    input.seekg(start);
+    long long expected = (2LL * numNodes + 1) * sizeof(int)
+                         + (long long) numArcs * (2 * sizeof(int) + sizeof(double));
+    if (start < 0 || remaining != expected) return false;
+    bool ok = readArray(input, ranks, numNodes) && readArray(input, offsets, numNodes + 1)
+              && readArray(input, targets, numArcs) && readArray(input, middles, numArcs)
+              && readArray(input, costs, numArcs);
+    if (!ok || !isConsistent()) {
+        clear();
+        return false;
+    }
+    graphFingerprint = hash;
+    return true;
+}
+
+/**
+ * Every upward arc must lead to a node of higher rank, and every
+ * shortcut must skip a node of lower rank than its start, which is
+ * what guarantees unpacking one comes to an end.
+ */
+
+bool ContractionHierarchy::isConsistent() const {
+    int numNodes = int(ranks.size());
+    int numArcs = int(targets.size());
+    if (offsets[0] != 0 || offsets[numNodes] != numArcs) return false;
+    for (int node = 0; node < numNodes; node++) {
+        if (offsets[node] > offsets[node + 1]) return false;
+        for (int arc = offsets[node]; arc < offsets[node + 1]; arc++) {
+            int target = targets[arc];
+            int middle = middles[arc];
+            if (target < 0 || target >= numNodes || ranks[target] <= ranks[node]) return false;
+            if (middle < -1 || middle >= numNodes) return false;
+            if (middle != -1 && ranks[middle] >= ranks[node]) return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,130 @@
+/**
+ * File: contraction-hierarchy.h
+ * -----------------------------
+ * Defines a contraction hierarchy, a form of a map that's slow to
+ * prepare but answers shortest-route queries while exploring only a
+ * few dozen nodes.  Preparing it contracts the nodes one at a time,
+ * least important first: each node is taken out of the graph, and
+ * wherever that would lengthen the shortest route between two of its
+ * neighbors, a shortcut arc standing for the two arcs through it is
+ * added in its place.  Every node ends up with a rank, the order it
+ * was contracted in, and the hierarchy keeps just the upward arcs,
+ * those from each node to neighbors of higher rank, shortcuts
+ * included.
+ *
+ * Some shortest route between any two nodes climbs from the source to
+ * a highest node and descends from there to the destination, so it can
+ * be found by two searches that each follow upward arcs only, one from
+ * either end.  Each shortcut remembers the node it was made to skip,
+ * which is all that's needed to expand it back into the arcs it stands
+ * for.  The hierarchy is stored in the same compressed sparse row form
+ * as a CompactGraph.
+ *
+ * A prepared hierarchy is saved next to its data file, as
+ * data-files/<map>.ch, in this layout:
+ *
+ *     "PFCH" version numNodes numArcs fingerprint ranks[numNodes]
+ *     offsets[numNodes + 1] targets[numArcs] middles[numArcs] costs[numArcs]
+ *
+ * with the counts and arrays of ints as 32-bit integers, the costs as
+ * doubles and the fingerprint as a 64-bit hash of the graph it was
+ * prepared from, all in the machine's own byte order.  The fingerprint
+ * is what keeps a hierarchy from being used with a data file that has
+ * changed since.
+ */
+
+#ifndef _contraction_hierarchy_h
+#define _contraction_hierarchy_h
+
+#include <string>
+#include <vector>
+#include "compact-graph.h"
+
+class ContractionHierarchy {
+public:
+    ContractionHierarchy();
+
+/**
+ * Method: build
+ * Usage: hierarchy.build(compact);
+ * --------------------------------
+ * Replaces the contents with a hierarchy prepared from the given
+ * graph, whose arcs must all run both ways.  This takes far longer than
+ * any search of the graph, so it's meant to be done once, offline, and
+ * saved.
+ */
+
+    void build(const CompactGraph& graph);
+
+/**
+ * Method: save
+ * Usage: if (hierarchy.save(filename)) ...
+ * ----------------------------------------
+ * Writes the hierarchy to the named file, and returns false if that
+ * can't be done.
+ */
+
+    bool save(const std::string& filename) const;
+
+/**
+ * Method: load
+ * Usage: if (hierarchy.load(filename, compact)) ...
+ * -------------------------------------------------
+ * Reads a hierarchy saved from the given graph back in.  If the file
+ * is missing, damaged or was prepared from some other graph, the
+ * hierarchy is left empty and load returns false.
+ */
+
+    bool load(const std::string& filename, const CompactGraph& graph);
+
+    void clear();
+    bool isEmpty() const { return offsets.empty(); }
+    int numNodes() const { return int(offsets.size()) - 1; }
+    int numArcs() const { return int(targets.size()); }
+
+/**
+ * Methods: arcsBegin, arcsEnd, target, cost
+ * Usage: for (int a = hierarchy.arcsBegin(node); a < hierarchy.arcsEnd(node); a++) ...
+ * ------------------------------------------------------------------------------------
+ * The upward arcs out of node occupy the slots [arcsBegin(node),
+ * arcsEnd(node)), just as in a CompactGraph.
+ */
+
+    int arcsBegin(int node) const { return offsets[node]; }
+    int arcsEnd(int node) const { return offsets[node + 1]; }
+    int target(int arc) const { return targets[arc]; }
+    double cost(int arc) const { return costs[arc]; }
+
+/**
+ * Method: unpack
+ * Usage: hierarchy.unpack(from, to, path);
+ * ----------------------------------------
+ * Appends to path the nodes of the original graph that the upward arc
+ * between from and to passes through, if it's a shortcut, followed by
+ * to itself.
+ */
+
+    void unpack(int from, int to, std::vector<int>& path) const;
+
+/**
+ * Method: fingerprint
+ * Usage: unsigned long long hash = ContractionHierarchy::fingerprint(compact);
+ * ---------------------------------------------------------------------------
+ * Returns a hash of the graph's nodes, arcs and costs.
+ */
+
+    static unsigned long long fingerprint(const CompactGraph& graph);
+
+private:
+    std::vector<int> ranks;       // the order each node was contracted in
+    std::vector<int> offsets;     // numNodes() + 1 entries; node i's upward arcs start at offsets[i]
+    std::vector<int> targets;
+    std::vector<int> middles;     // the node each shortcut skips, or -1 for an arc of the graph
+    std::vector<double> costs;
+    unsigned long long graphFingerprint;
+
+    int findArc(int from, int to) const;
+    bool isConsistent() const;
+};
+
+#endif
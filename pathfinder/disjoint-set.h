@@ -0,0 +1,99 @@
+/**
+ * File: disjoint-set.h
+ * --------------------
+ * Defines a partition of the small integer ids 0 through n - 1 into
+ * disjoint sets, which can be merged and asked which set an id is in.
+ * Each set is a tree of ids pointing towards a representative at its
+ * root.  Merging hangs the shallower tree from the root of the deeper
+ * one, and every find points the ids it passes straight at the root,
+ * so both operations take very nearly constant time however many are
+ * done.
+ */
+
+#ifndef _disjoint_set_h
+#define _disjoint_set_h
+
+#include <vector>
+
+class DisjointSet {
+public:
+
+/**
+ * Constructor: DisjointSet
+ * Usage: DisjointSet sets(numIds);
+ * --------------------------------
+ * Puts each of the ids 0 through numIds - 1 in a set of its own.
+ */
+
+    DisjointSet(int numIds = 0) {
+        reset(numIds);
+    }
+
+/**
+ * Method: reset
+ * Usage: sets.reset(numIds);
+ * --------------------------
+ * Starts over with each of the ids 0 through numIds - 1 in a set of
+ * its own.
+ */
+
+    void reset(int numIds) {
+        parent.resize(numIds);
+        for (int id = 0; id < numIds; id++) {
+            parent[id] = id;
+        }
+        rank.assign(numIds, 0);
+        numSets = numIds;
+    }
+
+/**
+ * Method: find
+ * Usage: int root = sets.find(id);
+ * --------------------------------
+ * Returns the representative of the set id is in, which is the same
+ * for every id in that set until it's merged with another.
+ */
+
+    int find(int id) {
+        int root = id;
+        while (parent[root] != root) root = parent[root];
+        while (parent[id] != root) {
+            int next = parent[id];
+            parent[id] = root;
+            id = next;
+        }
+        return root;
+    }
+
+/**
+ * Method: merge
+ * Usage: if (sets.merge(one, two)) ...
+ * ------------------------------------
+ * Merges the sets containing one and two, and returns false if they
+ * were already the same set.
+ */
+
+    bool merge(int one, int two) {
+        one = find(one);
+        two = find(two);
+        if (one == two) return false;
+        if (rank[one] < rank[two]) {
+            parent[one] = two;
+        } else {
+            parent[two] = one;
+            if (rank[one] == rank[two]) rank[one]++;
+        }
+        numSets--;
+        return true;
+    }
+
+    bool connected(int one, int two) { return find(one) == find(two); }
+    int countSets() const { return numSets; }
+
+private:
+    std::vector<int> parent;    // the next id towards the root, or the id itself at a root
+    std::vector<int> rank;      // at a root, a bound on the height of its tree
+    int numSets;
+};
+
+#endif
@@ -0,0 +1,294 @@
+/**
+ * File: graph-snapshot.cpp
+ * ------------------------
+ * Implements the GraphSnapshot class.  Mapping a file into memory
+ * needs the POSIX calls, which every system Pathfinder builds on has.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "graph-snapshot.h"
+
+using namespace std;
+
+static const char kMagic[] = "PFGS";
+static const int kMagicLength = 4;
+static const int kVersion = 2;
+
+/**
+ * Written as an int, this reads back as itself only on a machine with
+ * the same byte order as the one that wrote it.
+ */
+
+static const int kByteOrder = 0x01020304;
+
+/**
+ * Type: Header
+ * ------------
+ * The start of every snapshot, which is 56 bytes long with no padding
+ * on any machine where int is 32 bits and long long is 64.
+ */
+
+struct Header {
+    char magic[kMagicLength];
+    int byteOrder;
+    int version;
+    int numNodes;
+    int numArcs;
+    int namesSize;                // bytes of names, NULs included
+    long long sourceSize;             // the data file's size and a hash
+    unsigned long long sourceHash;    // of what's in it
+    double heuristicScale;
+    double costPerPixel;
+};
+
+/**
+ * Type: Layout
+ * ------------
+ * Where each array of a snapshot with the given counts starts, in bytes
+ * from the start of the file, and how long the whole file is.  Sizes
+ * are worked out in long long so that a damaged header can't overflow
+ * them.
+ */
+
+struct Layout {
+    long long xs, ys, costs, offsets, targets, nameOffsets, names, end;
+    Layout(long long numNodes, long long numArcs, long long namesSize);
+};
+
+static long long padded(long long bytes) {
+    return (bytes + 7) / 8 * 8;
+}
+
+Layout::Layout(long long numNodes, long long numArcs, long long namesSize) {
+    xs = padded(sizeof(Header));
+    ys = xs + numNodes * sizeof(double);
+    costs = ys + numNodes * sizeof(double);
+    offsets = costs + numArcs * sizeof(double);
+    targets = offsets + padded((numNodes + 1) * sizeof(int));
+    nameOffsets = targets + padded(numArcs * sizeof(int));
+    names = nameOffsets + padded((numNodes + 1) * sizeof(int));
+    end = names + namesSize;
+}
+
+/**
+ * Finds the size of the data file and a 64-bit FNV-1a hash of its
+ * bytes, and returns false if it can't be read.  Hashing is far quicker
+ * than parsing, and unlike a modification time it can't miss an edit
+ * made in the same second.
+ */
+
+static bool hashSource(const string& sourceFile, long long& size, unsigned long long& hash) {
+    ifstream input(sourceFile.c_str(), ios::binary);
+    if (!input) return false;
+    size = 0;
+    hash = 14695981039346656037ULL;
+    char buffer[65536];
+    while (input.read(buffer, sizeof(buffer)) || input.gcount() > 0) {
+        streamsize count = input.gcount();
+        for (streamsize i = 0; i < count; i++) {
+            hash = (hash ^ (unsigned char) buffer[i]) * 1099511628211ULL;
+        }
+        size += count;
+    }
+    return !input.bad();
+}
+
+/**
+ * Writes count values from the array and then zeros up to the next
+ * multiple of eight bytes.
+ */
+
+template <typename T>
+static void writeArray(ofstream& out, const T *values, long long count) {
+    if (count > 0) out.write((const char *) values, count * sizeof(T));
+    static const char zeros[8] = { 0 };
+    long long bytes = count * sizeof(T);
+    out.write(zeros, padded(bytes) - bytes);
+}
+
+GraphSnapshot::GraphSnapshot() {
+    mapping = NULL;
+    mappingSize = 0;
+    nameOffsets = NULL;
+    names = NULL;
+    heuristicScale = 0;
+}
+
+GraphSnapshot::~GraphSnapshot() {
+    close();
+}
+
+bool GraphSnapshot::save(const string& filename, const string& sourceFile,
+                         const Vector<Node *>& nodes, const CompactGraph& compact,
+                         double heuristicScale) {
+    int numNodes = nodes.size();
+    vector<double> xs(numNodes), ys(numNodes);
+    vector<int> nameOffsets(numNodes + 1, 0);
+    string names;
+    for (int i = 0; i < numNodes; i++) {
+        xs[i] = nodes[i]->loc.getX();
+        ys[i] = nodes[i]->loc.getY();
+        names += nodes[i]->name;
+        names += '\0';
+        nameOffsets[i + 1] = int(names.size());
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kMagic, kMagicLength);
+    header.byteOrder = kByteOrder;
+    header.version = kVersion;
+    header.numNodes = numNodes;
+    header.numArcs = compact.numArcs();
+    header.namesSize = int(names.size());
+    if (!hashSource(sourceFile, header.sourceSize, header.sourceHash)) return false;
+    header.heuristicScale = heuristicScale;
+    header.costPerPixel = compact.maxCostPerPixel();
+
+    string temporary = filename + ".tmp";
+    ofstream out(temporary.c_str(), ios::binary);
+    if (!out) return false;
+    writeArray(out, &header, 1);
+    writeArray(out, xs.empty() ? NULL : &xs[0], numNodes);
+    writeArray(out, ys.empty() ? NULL : &ys[0], numNodes);
+    writeArray(out, compact.costArray(), header.numArcs);
+    writeArray(out, compact.offsetArray(), numNodes + 1);
+    writeArray(out, compact.targetArray(), header.numArcs);
+    writeArray(out, &nameOffsets[0], numNodes + 1);
+    out.write(names.data(), names.size());
+    out.close();
+    if (out.fail() || rename(temporary.c_str(), filename.c_str()) != 0) {
+        remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Nothing in the file is trusted until the header's counts account for
+ * its length exactly and isConsistent has looked over the arrays.
+ */
+
+bool GraphSnapshot::open(const string& filename, const string& sourceFile) {
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+    void *address = mmap(NULL, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) return false;
+    mapping = address;
+    mappingSize = size_t(info.st_size);
+
+    const char *base = (const char *) mapping;
+    const Header *header = (const Header *) base;
+    long long sourceSize;
+    unsigned long long sourceHash;
+    if (memcmp(header->magic, kMagic, kMagicLength) != 0 || header->byteOrder != kByteOrder
+        || header->version != kVersion || header->numNodes < 0 || header->numArcs < 0
+        || header->namesSize < 0 || !hashSource(sourceFile, sourceSize, sourceHash)
+        || sourceSize != header->sourceSize || sourceHash != header->sourceHash) {
+        close();
+        return false;
+    }
+    Layout layout(header->numNodes, header->numArcs, header->namesSize);
+    if (layout.end != (long long) mappingSize) {
+        close();
+        return false;
+    }
+    compact.view(header->numNodes, (const int *) (base + layout.offsets),
+                 (const int *) (base + layout.targets), (const double *) (base + layout.costs),
+                 (const double *) (base + layout.xs), (const double *) (base + layout.ys),
+                 header->costPerPixel);
+    nameOffsets = (const int *) (base + layout.nameOffsets);
+    names = base + layout.names;
+    heuristicScale = header->heuristicScale;
+    if (!isConsistent()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void GraphSnapshot::close() {
+    if (mapping != NULL) munmap(mapping, mappingSize);
+    mapping = NULL;
+    mappingSize = 0;
+    nameOffsets = NULL;
+    names = NULL;
+    heuristicScale = 0;
+    compact = CompactGraph();
+}
+
+/**
+ * Every arc must lead to a node and cost nothing less than zero, and
+ * every name must end in a NUL of its own, so that no search or name
+ * reads off the end of the file.  The largest scale the arcs allow is
+ * worked out again just as CompactGraph::build does, and A*'s scale
+ * can't be above it, since an estimate that's ever too high can make
+ * A* miss the shortest route.
+ */
+
+bool GraphSnapshot::isConsistent() const {
+    const Header *header = (const Header *) mapping;
+    int numNodes = header->numNodes;
+    const int *offsets = compact.offsetArray();
+    if (offsets[0] != 0 || offsets[numNodes] != header->numArcs) return false;
+    if (nameOffsets[0] != 0 || nameOffsets[numNodes] != header->namesSize) return false;
+    for (int node = 0; node < numNodes; node++) {
+        if (offsets[node + 1] < offsets[node]) return false;
+        if (nameOffsets[node + 1] <= nameOffsets[node]
+            || nameOffsets[node + 1] > header->namesSize
+            || names[nameOffsets[node + 1] - 1] != '\0') {
+            return false;
+        }
+    }
+    double costPerPixel = HUGE_VAL;
+    for (int node = 0; node < numNodes; node++) {
+        for (int arc = offsets[node]; arc < offsets[node + 1]; arc++) {
+            int target = compact.target(arc);
+            double cost = compact.cost(arc);
+            if (target < 0 || target >= numNodes || !(cost >= 0)) return false;
+            double length = compact.distance(node, target);
+            if (length > 0) costPerPixel = min(costPerPixel, cost / length);
+        }
+    }
+    return header->costPerPixel == costPerPixel && header->heuristicScale >= 0
+           && header->heuristicScale <= costPerPixel && header->heuristicScale < HUGE_VAL;
+}
+
+bool GraphSnapshot::isOpen() const {
+    return mapping != NULL;
+}
+
+int GraphSnapshot::numNodes() const {
+    return compact.numNodes();
+}
+
+const char *GraphSnapshot::getName(int node) const {
+    return names + nameOffsets[node];
+}
+
+GPoint GraphSnapshot::getLocation(int node) const {
+    return GPoint(compact.xArray()[node], compact.yArray()[node]);
+}
+
+const CompactGraph& GraphSnapshot::getCompactGraph() const {
+    return compact;
+}
+
+double GraphSnapshot::getHeuristicScale() const {
+    return heuristicScale;
+}
@@ -0,0 +1,124 @@
+/**
+ * File: graph-snapshot.h
+ * ----------------------
+ * Defines a snapshot of a loaded map, saved in a binary form that can
+ * be mapped straight into memory and used where it lies, with nothing
+ * to parse and nothing to copy.  However big the map, opening one only
+ * checks that its arrays hang together and that the data file it was
+ * saved from hasn't changed.  The snapshot holds each
+ * node's name and location and the map's arcs in the same compressed
+ * sparse row form as a CompactGraph, which it serves directly out of
+ * the mapped file.
+ *
+ * A snapshot is saved next to its data file, as data-files/<map>.pfg,
+ * in this layout:
+ *
+ *     "PFGS" byteOrder version numNodes numArcs namesSize sourceSize
+ *     sourceHash heuristicScale costPerPixel xs[numNodes] ys[numNodes]
+ *     costs[numArcs] offsets[numNodes + 1] targets[numArcs]
+ *     nameOffsets[numNodes + 1] names[namesSize]
+ *
+ * with the counts and arrays of ints as 32-bit integers, the source's
+ * size and hash as 64-bit integers, the locations, costs and scales as
+ * doubles and the names back to back, each ending in a NUL, all in the
+ * machine's own byte order.  Every array starts on a multiple of eight
+ * bytes, padding with zeros where needed.  The data file's size and a
+ * hash of its contents are what keep a snapshot from being used once
+ * the data file has changed.
+ */
+
+#ifndef _graph_snapshot_h
+#define _graph_snapshot_h
+
+#include <cstddef>
+#include <string>
+#include "compact-graph.h"
+#include "graphtypes.h"
+#include "vector.h"
+
+class GraphSnapshot {
+public:
+    GraphSnapshot();
+    ~GraphSnapshot();
+
+/**
+ * Method: save
+ * Usage: GraphSnapshot::save(filename, sourceFile, nodes, compact, scale);
+ * ------------------------------------------------------------------------
+ * Saves a snapshot of the given nodes, numbered by their positions in
+ * nodes, and of the arcs in compact, which must have been built from
+ * them, along with the scale A* should use.  sourceFile names the data
+ * file they were loaded from.  The file is written under another name
+ * and then renamed, so a snapshot that's open, even this one, is never
+ * changed underneath anyone.  Returns false if it can't be written or
+ * sourceFile can't be read.
+ */
+
+    static bool save(const std::string& filename, const std::string& sourceFile,
+                     const Vector<Node *>& nodes, const CompactGraph& compact,
+                     double heuristicScale);
+
+/**
+ * Method: open
+ * Usage: if (snapshot.open(filename, sourceFile)) ...
+ * ---------------------------------------------------
+ * Closes whatever snapshot was open and maps the one in filename into
+ * memory.  Returns false, leaving no snapshot open, if it isn't there,
+ * isn't a snapshot this version can read or is damaged, or if sourceFile
+ * is missing or isn't the data file it was saved from.  Checking that
+ * reads sourceFile through once, without parsing it.
+ */
+
+    bool open(const std::string& filename, const std::string& sourceFile);
+
+/**
+ * Method: close
+ * Usage: snapshot.close();
+ * ------------------------
+ * Unmaps the snapshot, if one is open.  Any names or CompactGraph it
+ * handed out, copies of that graph included, can't be used after.
+ */
+
+    void close();
+
+    bool isOpen() const;
+    int numNodes() const;
+
+/**
+ * Method: getName, getLocation
+ * Usage: const char *name = snapshot.getName(node);
+ * -------------------------------------------------
+ * Return the name and screen location of the node with the given
+ * number.  The name is in the mapped file itself.
+ */
+
+    const char *getName(int node) const;
+    GPoint getLocation(int node) const;
+
+/**
+ * Method: getCompactGraph
+ * Usage: const CompactGraph& compact = snapshot.getCompactGraph();
+ * ----------------------------------------------------------------
+ * Returns the arcs of the map as a CompactGraph that views the mapped
+ * file, so the searches run out of it directly.
+ */
+
+    const CompactGraph& getCompactGraph() const;
+    double getHeuristicScale() const;
+
+private:
+    void *mapping;
+    size_t mappingSize;
+    const int *nameOffsets;
+    const char *names;
+    CompactGraph compact;
+    double heuristicScale;
+
+    bool isConsistent() const;
+
+    // The mapping belongs to one snapshot only, so snapshots can't be copied.
+    GraphSnapshot(const GraphSnapshot&);
+    GraphSnapshot& operator=(const GraphSnapshot&);
+};
+
+#endif
@@ -9,7 +9,7 @@
 
 #include <string>
 #include "gtypes.h"
-#include <map>
+#include "hashmap.h"
 #include "set.h"
 
 struct Node;     /* Forward references to these two types so  */
@@ -19,20 +19,23 @@ struct Arc;      /* that the C++ compiler can recognize them. */
  * Type: SimpleGraph
  * -----------------
  * This type represents a graph and consists of a set of nodes, a set of
- * arcs, and a map that creates an association between names and nodes.
+ * arcs, and a hash table that creates an association between names and
+ * nodes.
  */
 
 struct SimpleGraph {
    Set<Node *> nodes;
    Set<Arc *> arcs;
-   map<std::string, Node *> nodeMap;
+   HashMap<std::string, Node *> nodeMap;
 };
 
 /*
  * Type: Node
  * ----------
  * This type represents an individual node and consists of the
- * name of the node and the set of arcs from this node.
+ * name of the node and the set of arcs from this node.  Nodes are
+ * also numbered densely from 0, in index, so that algorithms can keep
+ * what they know about each node in plain arrays.
  */
 
 struct Node {
@@ -40,6 +43,7 @@ struct Node {
    Set<Arc *> arcs;
    GPoint loc;
    double dist;
+   int index;
 };
 
 /*
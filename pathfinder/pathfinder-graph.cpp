@@ -5,8 +5,13 @@
  * the PathfinderGraph class.
  */
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include "pathfinder-graph.h"
-#include "tokenscanner.h"
 #include "strlib.h"
 #include "simpio.h"
 
@@ -43,129 +48,335 @@ bool PathfinderGraph::checkNodes() {
 }
 
 
+/**
+ * Type: Field
+ * -----------
+ * One whitespace-separated word of a line, left where it is in the
+ * file's text.
+ */
+
+struct Field {
+    const char *begin;
+    const char *end;
+};
+
+static bool readWholeFile(const string& filename, string& text);
+static int splitFields(const char *line, const char *end, Field fields[], int maxFields);
+static bool fieldIs(const Field& field, const char *word);
+static bool parseNumber(const Field& field, double& value);
+static string atLine(const string& filename, int lineNumber, const string& problem);
+
+/**
+ * The data file is read in one go and parsed in a single pass over its
+ * text, line by line, without copying any line out of it.  Nodes are
+ * numbered in the order they're listed, and arcs find their ends by
+ * name through the graph's hash table of nodes.  The first problem
+ * found stops the load, and leaves the graph empty with a message,
+ * naming the line, for getLoadError.
+ */
+
 int PathfinderGraph::loadDataFile(const string& filename) {
     dataFile.nodeMap.clear();
     dataFile.nodes.clear();
     dataFile.arcs.clear();
     kruskalarcs.clear();
-    
+    nodeList.clear();
+    selected.clear();
+    hierarchy.clear();
+    loadError = "";
 
-    map<string, Node *>::iterator iter;
-    ifstream inp;
     string datafile = "data-files/" + filename + ".txt";
-    inp.open(datafile.c_str());
-        if (inp.is_open() == true) {
-            if (inp.fail()) { error("Could not open file");
-                inp.clear();
-                return -1;
-            }
+    dataFilePath = datafile;
+    hierarchyFile = "data-files/" + filename + ".ch";
+    snapshotFile = "data-files/" + filename + ".pfg";
+    if (snapshot.open(snapshotFile, datafile)) {
+        return loadSnapshot();
     }
-    string row;
-    Vector<string> filereadout;
-    while (getline(inp, row)) {
-        filereadout.add(row);
+
+    string text;
+    if (!readWholeFile(datafile, text)) {
+        return abandonLoad(datafile + ": can't be read");
     }
-    inp.close();
 
-    filereadout.remove(0);
-    filereadout.remove(0);
-    TokenScanner scanner;
-    scanner.ignoreWhitespace();
-    
-    while (true) {
-        string line = filereadout[0];
-        if (line == "ARCS") break;
-        Node *newnode = new Node;
-        double x;
-        double y;
-        scanner.setInput(line);
-        string nodename;
-            for (int i = 0; i < 3; i++) {
-                string next = scanner.nextToken();
-                if (i == 0) {
-                    
-                    newnode->name = next;
-                    nodename = next;
-                    newnode->dist = INFIN_VAL;
-                }
-                else if (i == 1) {
-                    
-                    x = stringToReal(next);
-                }
-                else if (i == 2) {
-                    
-                    y = stringToReal(next);
+    enum Section { Image, Header, Nodes, Arcs };
+    Section section = Image;
+    double declaredScale = HUGE_VAL;
+    int lineNumber = 0;
+    const char *cursor = text.c_str();
+    const char *stop = cursor + text.size();
+    while (cursor < stop) {
+        const char *line = cursor;
+        const char *lineEnd = (const char *) memchr(line, '\n', stop - line);
+        if (lineEnd == NULL) lineEnd = stop;
+        cursor = lineEnd + 1;
+        lineNumber++;
+        Field fields[4];
+        int count = splitFields(line, lineEnd, fields, 4);
+        if (count == 0) continue;
+
+        if (section == Image) {
+            section = Header;
+        } else if (section == Header) {
+            if (fieldIs(fields[0], "SCALE")) {
+                if (count != 2 || !parseNumber(fields[1], declaredScale) || declaredScale < 0) {
+                    return abandonLoad(atLine(datafile, lineNumber,
+                                              "expected SCALE and a cost per pixel"));
                 }
+            } else if (fieldIs(fields[0], "NODES") && count == 1) {
+                section = Nodes;
+            } else {
+                return abandonLoad(atLine(datafile, lineNumber, "expected NODES"));
             }
-        GPoint location(x, y);
-        newnode->loc = location;
-        dataFile.nodeMap.insert(pair<string, Node *> (nodename, newnode));
-
-        filereadout.remove(0);
-    }
-    
-    filereadout.remove(0);
-    
-    while (filereadout.size() > 0) {
-        string line = filereadout[0];
-        scanner.setInput(line);
-        Arc *newarc1 = new Arc;
-        Arc *newarc2 = new Arc;
-        Node *currnode = new Node;
-        Node *nextnode = new Node;
-        string one;
-        string two;
-        for (int i = 0; i < 3; i++) {
-            if (i == 0) {
-                one = scanner.nextToken();
-                iter = dataFile.nodeMap.find(one);
-                currnode = iter->second;
-                newarc1->start = currnode;
-                newarc2->finish = currnode;
+        } else if (section == Nodes) {
+            if (fieldIs(fields[0], "ARCS") && count == 1) {
+                section = Arcs;
+                continue;
+            }
+            double x, y;
+            if (count != 3 || !parseNumber(fields[1], x) || !parseNumber(fields[2], y)) {
+                return abandonLoad(atLine(datafile, lineNumber,
+                                          "expected a node's name and its x and y"));
             }
-            else if (i == 1) {
-                two = scanner.nextToken();
-                iter = dataFile.nodeMap.find(two);
-                nextnode = iter->second;
-                newarc1->finish = nextnode;
-                newarc2->start = nextnode;
+            string name(fields[0].begin, fields[0].end);
+            if (dataFile.nodeMap.containsKey(name)) {
+                return abandonLoad(atLine(datafile, lineNumber,
+                                          "there's already a node named " + name));
             }
-            else if (i == 2) {
-                scanner.scanNumbers();
-                string thirdstring = scanner.nextToken();
-                double third = stringToReal(thirdstring);
-                newarc1->cost = third;
-                newarc2->cost = third;
+            Node *newnode = new Node;
+            newnode->name = name;
+            newnode->loc = GPoint(x, y);
+            newnode->dist = INFIN_VAL;
+            newnode->index = nodeList.size();
+            nodeList.add(newnode);
+            dataFile.nodeMap.put(name, newnode);
+        } else {
+            double cost;
+            if (count != 3 || !parseNumber(fields[2], cost)) {
+                return abandonLoad(atLine(datafile, lineNumber,
+                                          "expected the names of two nodes and a cost"));
             }
+            if (cost < 0) {
+                return abandonLoad(atLine(datafile, lineNumber,
+                                          "an arc can't have a negative cost"));
+            }
+            string one(fields[0].begin, fields[0].end);
+            string two(fields[1].begin, fields[1].end);
+            Node *currnode = dataFile.nodeMap.get(one);
+            Node *nextnode = dataFile.nodeMap.get(two);
+            if (currnode == NULL || nextnode == NULL) {
+                return abandonLoad(atLine(datafile, lineNumber,
+                                          "there's no node named "
+                                          + (currnode == NULL ? one : two)));
+            }
+            Arc *newarc1 = new Arc;
+            Arc *newarc2 = new Arc;
+            newarc1->start = newarc2->finish = currnode;
+            newarc1->finish = newarc2->start = nextnode;
+            newarc1->cost = newarc2->cost = cost;
+            kruskalarcs.add(newarc1);
+            currnode->arcs.add(newarc1);
+            nextnode->arcs.add(newarc2);
+            dataFile.arcs.add(newarc1);
+            dataFile.arcs.add(newarc2);
         }
-        kruskalarcs.add(newarc1);
-        currnode->arcs.add(newarc1);
-        nextnode->arcs.add(newarc2);
-        dataFile.arcs.add(newarc1);
-        dataFile.arcs.add(newarc2);
-        filereadout.remove(0);
     }
-    
-    foreach (string word in dataFile.nodeMap) {
-        iter = dataFile.nodeMap.find(word);
-        Node *nextnode = iter->second;
-        dataFile.nodes.add(nextnode);
+    if (section == Image || section == Header) {
+        return abandonLoad(datafile + ": there's no NODES line");
     }
-    if (filereadout.isEmpty()) return 1;
+
+    for (int i = 0; i < nodeList.size(); i++) {
+        dataFile.nodes.add(nodeList[i]);
+    }
+    compact.build(nodeList);
+    spatial.build(nodeList);
+    hierarchy.load(hierarchyFile, compact);
+    heuristicScale = min(declaredScale, compact.maxCostPerPixel());
+    if (heuristicScale == HUGE_VAL) heuristicScale = 0;
     return 0;
 }
 
-Set<Node *> PathfinderGraph::getNodes() {
-    Set<Node *> result = dataFile.nodes;
-    return result;
+/**
+ * The searches run on the snapshot's own arrays, so only the Nodes and
+ * Arcs the rest of Pathfinder draws and edits are made, straight from
+ * those arrays, with nothing parsed and no names looked up.  Each pair
+ * of arcs that a line of the data file made, one each way, is back in
+ * getKruskalArcs once, as the arc from the lower-numbered node.  An arc
+ * from a node to itself comes in twice, so every other one is taken.
+ */
+
+int PathfinderGraph::loadSnapshot() {
+    compact = snapshot.getCompactGraph();
+    int numNodes = compact.numNodes();
+    for (int i = 0; i < numNodes; i++) {
+        Node *newnode = new Node;
+        newnode->name = snapshot.getName(i);
+        newnode->loc = snapshot.getLocation(i);
+        newnode->dist = INFIN_VAL;
+        newnode->index = i;
+        nodeList.add(newnode);
+        dataFile.nodes.add(newnode);
+        dataFile.nodeMap.put(newnode->name, newnode);
+    }
+    for (int i = 0; i < numNodes; i++) {
+        Node *currnode = nodeList[i];
+        bool secondLoop = false;
+        for (int arc = compact.arcsBegin(i); arc < compact.arcsEnd(i); arc++) {
+            Arc *newarc = new Arc;
+            newarc->start = currnode;
+            newarc->finish = nodeList[compact.target(arc)];
+            newarc->cost = compact.cost(arc);
+            currnode->arcs.add(newarc);
+            dataFile.arcs.add(newarc);
+            if (compact.target(arc) == i) {
+                if (!secondLoop) kruskalarcs.add(newarc);
+                secondLoop = !secondLoop;
+            } else if (compact.target(arc) > i) {
+                kruskalarcs.add(newarc);
+            }
+        }
+    }
+    spatial.build(nodeList);
+    hierarchy.load(hierarchyFile, compact);
+    heuristicScale = snapshot.getHeuristicScale();
+    return 0;
 }
 
-Set<Arc *> PathfinderGraph::getArcs() {
-    Set<Arc *> result = dataFile.arcs;
-    return result;
+/**
+ * Every arc read so far is in exactly one node's set of arcs, the node
+ * it starts from, so deleting those sets' arcs along with the nodes
+ * frees everything the load made.
+ */
+
+int PathfinderGraph::abandonLoad(const string& problem) {
+    for (int i = 0; i < nodeList.size(); i++) {
+        foreach (Arc *arc in nodeList[i]->arcs) {
+            delete arc;
+        }
+        delete nodeList[i];
+    }
+    dataFile.nodeMap.clear();
+    dataFile.nodes.clear();
+    dataFile.arcs.clear();
+    kruskalarcs.clear();
+    nodeList.clear();
+    compact.build(nodeList);
+    spatial.build(nodeList);
+    heuristicScale = 0;
+    loadError = problem;
+    return -1;
+}
+
+const string& PathfinderGraph::getLoadError() const {
+    return loadError;
+}
+
+static string atLine(const string& filename, int lineNumber, const string& problem) {
+    return filename + ":" + integerToString(lineNumber) + ": " + problem;
+}
+
+static bool readWholeFile(const string& filename, string& text) {
+    ifstream input(filename.c_str(), ios::binary);
+    if (!input) return false;
+    input.seekg(0, ios::end);
+    streamoff size = input.tellg();
+    if (size < 0) return false;
+    input.seekg(0, ios::beg);
+    text.resize(size_t(size));
+    return size == 0 || input.read(&text[0], size);
+}
+
+/**
+ * Returns how many fields the line has, stopping at maxFields + 1 so
+ * that a line with too many can be told from one with just enough.  A
+ * carriage return counts as whitespace, which takes care of files with
+ * DOS line endings.
+ */
+
+static int splitFields(const char *line, const char *end, Field fields[], int maxFields) {
+    int count = 0;
+    const char *cp = line;
+    while (true) {
+        while (cp < end && isspace((unsigned char) *cp)) cp++;
+        if (cp == end) return count;
+        if (count == maxFields) return count + 1;
+        fields[count].begin = cp;
+        while (cp < end && !isspace((unsigned char) *cp)) cp++;
+        fields[count].end = cp;
+        count++;
+    }
+}
+
+static bool fieldIs(const Field& field, const char *word) {
+    size_t length = strlen(word);
+    return size_t(field.end - field.begin) == length && memcmp(field.begin, word, length) == 0;
+}
+
+/**
+ * strtod stops at the whitespace after the field, or at the NUL after
+ * the whole text, so it never reads past the file.
+ */
+
+static bool parseNumber(const Field& field, double& value) {
+    char *end;
+    value = strtod(field.begin, &end);
+    return end == field.end && value == value && fabs(value) != HUGE_VAL;
+}
+
+const Set<Node *>& PathfinderGraph::getNodes() const {
+    return dataFile.nodes;
+}
+
+int PathfinderGraph::numNodes() const {
+    return nodeList.size();
+}
+
+Node *PathfinderGraph::getNode(int index) const {
+    return nodeList[index];
+}
+
+const CompactGraph& PathfinderGraph::getCompactGraph() const {
+    return compact;
+}
+
+/**
+ * Taking arcs away can only raise the largest scale the arcs allow, so
+ * the scale A* uses stays safe and is left alone.
+ */
+
+void PathfinderGraph::rebuildCompactGraph() {
+    compact.build(nodeList);
+    hierarchy.clear();
+}
+
+double PathfinderGraph::getHeuristicScale() const {
+    return heuristicScale;
+}
+
+const SpatialIndex& PathfinderGraph::getSpatialIndex() const {
+    return spatial;
+}
+
+const ContractionHierarchy& PathfinderGraph::getHierarchy() const {
+    return hierarchy;
+}
+
+const string& PathfinderGraph::getHierarchyFile() const {
+    return hierarchyFile;
+}
+
+bool PathfinderGraph::saveSnapshot() const {
+    return GraphSnapshot::save(snapshotFile, dataFilePath, nodeList, compact, heuristicScale);
+}
+
+const string& PathfinderGraph::getSnapshotFile() const {
+    return snapshotFile;
+}
+
+const Set<Arc *>& PathfinderGraph::getArcs() const {
+    return dataFile.arcs;
 }
 
-Vector<Node *> PathfinderGraph::getSelected() {
+const Vector<Node *>& PathfinderGraph::getSelected() const {
     return selected;
 }
 
@@ -176,6 +387,6 @@ void PathfinderGraph::clearArcs() {
     }
 }
 
-Vector<Arc *> PathfinderGraph::getKruskalArcs() {
+const Vector<Arc *>& PathfinderGraph::getKruskalArcs() const {
     return kruskalarcs;
 }
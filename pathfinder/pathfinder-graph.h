@@ -9,6 +9,10 @@
 #include <string>
    
 #include "graphtypes.h" // for struct Node
+#include "compact-graph.h"
+#include "contraction-hierarchy.h"
+#include "graph-snapshot.h"
+#include "spatial-index.h"
 
 /**
  * Class: PathfinderGraph
@@ -26,23 +30,152 @@ class PathfinderGraph {
 
 
 public:
+
+/**
+ * Method: setMapFile
+ * Usage: if (graph.setMapFile(name) == -1) ... graph.getLoadError() ...
+ * ---------------------------------------------------------------------
+ * Replaces the graph with the map in data-files/<name>.txt.  Returns 0
+ * once it's loaded, or -1 if the file can't be read or has a mistake in
+ * it, in which case the graph is left empty and getLoadError says what
+ * went wrong and on which line.  If there's a snapshot of the map, in
+ * the file getSnapshotFile names, that was saved from the data file as
+ * it is now, the map is loaded from that instead, without parsing the
+ * data file.
+ */
+
     int setMapFile(const std::string& filename);
+    const std::string& getLoadError() const;
     const std::string& getMapFile() const;
     void setHighlightedNode(Node *node);
     Node *getHighlightedNode() const;
     bool checkNodes();
-    Set<Node *> getNodes();
-    Set<Arc *> getArcs();
-    Vector<Node *> getSelected();
+
+/**
+ * Method: getNodes, getArcs, getSelected, getKruskalArcs
+ * Usage: const Set<Node *>& nodes = graph.getNodes();
+ * ---------------------------------------------------
+ * These return the graph's own collections rather than copies, so
+ * they're free to call however big the map is.  Each stays valid until
+ * the graph changes it: the next setMapFile for all of them, clearArcs
+ * for getArcs and setHighlightedNode for getSelected.  To visit every
+ * node, numNodes and getNode are quicker still.
+ */
+
+    const Set<Node *>& getNodes() const;
+
+/**
+ * Method: numNodes, getNode
+ * Usage: for (int i = 0; i < graph.numNodes(); i++) ... graph.getNode(i) ...
+ * -------------------------------------------------------------------------
+ * Every node is numbered from 0 to numNodes() - 1, in the order the
+ * data file lists them, and getNode returns the node with the given
+ * number.
+ */
+
+    int numNodes() const;
+    Node *getNode(int index) const;
+
+/**
+ * Method: getCompactGraph
+ * Usage: const CompactGraph& compact = graph.getCompactGraph();
+ * -------------------------------------------------------------
+ * Returns the arcs of the map laid out for fast traversal.  It's built
+ * by setMapFile, and again by rebuildCompactGraph once the nodes' arcs
+ * have been changed.
+ */
+
+    const CompactGraph& getCompactGraph() const;
+
+/**
+ * Method: rebuildCompactGraph
+ * Usage: graph.rebuildCompactGraph();
+ * -----------------------------------
+ * Lays out the arcs the nodes have now, after clearArcs and whatever
+ * arcs were added back, so that searches follow the map as it's shown.
+ * The contraction hierarchy was prepared for the map as it was loaded,
+ * so it's dropped.
+ */
+
+    void rebuildCompactGraph();
+
+/**
+ * Method: getSpatialIndex
+ * Usage: int node = graph.getSpatialIndex().nearest(x, y, radius);
+ * ----------------------------------------------------------------
+ * Returns an index of where the nodes are, for finding the one nearest
+ * a point.  Like the compact graph, it's built once by setMapFile.
+ */
+
+    const SpatialIndex& getSpatialIndex() const;
+
+/**
+ * Method: getHeuristicScale
+ * Usage: double scale = graph.getHeuristicScale();
+ * ------------------------------------------------
+ * Returns the cost per pixel A* multiplies straight-line distances by
+ * to estimate how far a node is from the destination.  A data file can
+ * declare it with a line such as
+ *
+ *     SCALE 3.9
+ *
+ * between the image name and NODES; otherwise it's the largest scale
+ * the arcs allow.  A declared scale larger than that is lowered to it,
+ * since an estimate that's ever too high can make A* miss the shortest
+ * route.
+ */
+
+    double getHeuristicScale() const;
+
+/**
+ * Method: getHierarchy, getHierarchyFile
+ * Usage: const ContractionHierarchy& hierarchy = graph.getHierarchy();
+ * --------------------------------------------------------------------
+ * Returns the contraction hierarchy prepared for this map, which is
+ * empty unless one was found in the file getHierarchyFile names when
+ * the map was loaded, and once the arcs have been rebuilt.  The
+ * pathfinder-prepare tool writes that file.
+ */
+
+    const ContractionHierarchy& getHierarchy() const;
+    const std::string& getHierarchyFile() const;
+
+/**
+ * Method: saveSnapshot, getSnapshotFile
+ * Usage: if (!graph.saveSnapshot()) ...
+ * -------------------------------------
+ * Saves a snapshot of the map as it was loaded in the file that
+ * getSnapshotFile names, where setMapFile looks for one, and returns
+ * false if it can't be written.  The pathfinder-prepare tool saves one
+ * for each map it prepares.
+ */
+
+    bool saveSnapshot() const;
+    const std::string& getSnapshotFile() const;
+
+    const Set<Arc *>& getArcs() const;
+    const Vector<Node *>& getSelected() const;
     void clearArcs();
-    Vector<Arc *> getKruskalArcs();
+    const Vector<Arc *>& getKruskalArcs() const;
 
 private:
     std::string mapFile;
     Node *highlightedNode;
     int loadDataFile(const string& filename);
+    int loadSnapshot();
+    int abandonLoad(const string& problem);
+    std::string loadError;
     SimpleGraph dataFile;
     Vector<Arc *> kruskalarcs;
+    Vector<Node *> nodeList;
+    CompactGraph compact;
+    SpatialIndex spatial;
+    ContractionHierarchy hierarchy;
+    std::string hierarchyFile;
+    std::string dataFilePath;
+    std::string snapshotFile;
+    GraphSnapshot snapshot;       // the snapshot compact views, if it was loaded from one
+    double heuristicScale;
     Vector<Node *> selected;
     static const double INFIN_VAL = 1000000;
 };
@@ -0,0 +1,150 @@
+/**
+ * File: pathfinder-prepare.cpp
+ * ----------------------------
+ * Prepares a contraction hierarchy for each map named on the command
+ * line and saves it next to the map's data file, where Pathfinder finds
+ * it when the map is loaded, along with a snapshot of the map that
+ * loads without parsing the data file.  Preparing is slow, but only has
+ * to be done again when the data file changes.  It then times random queries
+ * on the hierarchy against plain Dijkstra and checks that the two
+ * agree.
+ *
+ * This file has its own main, so it isn't part of the pathfinder
+ * target.  It needs no window system:
+ *
+ *     g++ -O2 -IStanfordCPPLib -o pathfinder-prepare pathfinder-prepare.cpp \
+ *         pathfinder-graph.cpp compact-graph.cpp contraction-hierarchy.cpp \
+ *         graph-snapshot.cpp spatial-index.cpp shortest-path.cpp -LStanfordCPPLib -lStanfordCPPLib
+ *
+ * Usage: pathfinder-prepare [--queries <n>] <map> ...
+ *
+ *     --queries <n>   random queries to time and check on each map (1000)
+ *     <map>           the name of a data file, such as USA, without its extension
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/time.h>
+#include "pathfinder-graph.h"
+#include "contraction-hierarchy.h"
+#include "shortest-path.h"
+using namespace std;
+
+static void usage(const string& problem);
+static double now();
+static bool prepareMap(const string& name, int numQueries);
+static bool compareQueries(const PathfinderGraph& graph, int numQueries);
+
+int main(int argc, char *argv[]) {
+    int numQueries = 1000;
+    int numMaps = 0;
+    bool ok = true;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--queries") {
+            if (i + 1 >= argc) usage("missing value for --queries");
+            istringstream value(argv[++i]);
+            if (!(value >> numQueries) || numQueries < 0) usage("bad value for --queries");
+        } else {
+            ok = prepareMap(arg, numQueries) && ok;
+            numMaps++;
+        }
+    }
+    if (numMaps == 0) usage("no maps named");
+    return ok ? 0 : 1;
+}
+
+static void usage(const string& problem) {
+    cerr << "pathfinder-prepare: " << problem << endl;
+    cerr << "usage: pathfinder-prepare [--queries <n>] <map> ..." << endl;
+    exit(1);
+}
+
+static double now() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/**
+ * The map is loaded a second time once the hierarchy and snapshot are
+ * saved, which checks that both files read back and leaves the
+ * hierarchy where the searches will find it.
+ */
+
+static bool prepareMap(const string& name, int numQueries) {
+    PathfinderGraph graph;
+    if (graph.setMapFile(name) == -1 || graph.numNodes() == 0) {
+        cerr << name << ": can't load the data file" << endl;
+        return false;
+    }
+    double start = now();
+    ContractionHierarchy hierarchy;
+    hierarchy.build(graph.getCompactGraph());
+    double elapsed = now() - start;
+    if (!hierarchy.save(graph.getHierarchyFile())) {
+        cerr << name << ": can't write " << graph.getHierarchyFile() << endl;
+        return false;
+    }
+    if (!graph.saveSnapshot()) {
+        cerr << name << ": can't write " << graph.getSnapshotFile() << endl;
+        return false;
+    }
+    int numNodes = graph.numNodes();
+    start = now();
+    graph.setMapFile(name);
+    double reload = now() - start;
+    if (graph.numNodes() != numNodes) {
+        cerr << name << ": " << graph.getSnapshotFile() << " doesn't read back" << endl;
+        return false;
+    }
+    if (graph.getHierarchy().isEmpty()) {
+        cerr << name << ": " << graph.getHierarchyFile() << " doesn't read back" << endl;
+        return false;
+    }
+    cout << name << ": " << graph.numNodes() << " nodes, "
+         << graph.getCompactGraph().numArcs() << " arcs, "
+         << hierarchy.numArcs() << " upward arcs in " << elapsed << " seconds, saved to "
+         << graph.getHierarchyFile() << endl;
+    cout << "    " << graph.getSnapshotFile() << " loads in " << reload << " seconds" << endl;
+    return compareQueries(graph, numQueries);
+}
+
+static bool compareQueries(const PathfinderGraph& graph, int numQueries) {
+    if (numQueries == 0) return true;
+    vector<int> sources, destinations;
+    srand(1);
+    for (int i = 0; i < numQueries; i++) {
+        sources.push_back(rand() % graph.numNodes());
+        destinations.push_back(rand() % graph.numNodes());
+    }
+    ShortestPathFinder::Algorithm algorithms[] = {
+        ShortestPathFinder::Dijkstra, ShortestPathFinder::Hierarchy
+    };
+    const char *names[] = { "Dijkstra", "hierarchy" };
+    vector<double> costs[2];
+    for (int a = 0; a < 2; a++) {
+        ShortestPathFinder finder;
+        long long expanded = 0;
+        double start = now();
+        for (int i = 0; i < numQueries; i++) {
+            bool found = finder.findPath(graph, sources[i], destinations[i], algorithms[a]);
+            costs[a].push_back(found ? finder.getCost() : -1);
+            expanded += finder.getNodesExpanded();
+        }
+        double elapsed = now() - start;
+        cout << "    " << names[a] << ": " << elapsed * 1e6 / numQueries << " us/query, "
+             << double(expanded) / numQueries << " nodes expanded" << endl;
+    }
+    for (int i = 0; i < numQueries; i++) {
+        if (fabs(costs[0][i] - costs[1][i]) > 1e-9 * max(1.0, fabs(costs[0][i]))) {
+            cerr << "    the two disagree on the route from node " << sources[i]
+                 << " to node " << destinations[i] << endl;
+            return false;
+        }
+    }
+    return true;
+}
@@ -11,7 +11,6 @@
 #include "console.h"
 #include "pathfinder-graph.h"
 #include "pathfinder-graphics.h"
-#include "pqueue-heap.h"
 #include "error.h"
 #include "gwindow.h"
 #include <map>
@@ -23,6 +22,8 @@
 #include "strlib.h"
 #include "vector.h"
 #include "path.h"
+#include "shortest-path.h"
+#include "spanning-tree.h"
 #include "lexicon.h"
 
 using namespace std;
@@ -45,13 +46,28 @@ static void giveInstructions();
 static Node *findNode(const GPoint &pt, PathfinderGraph *&graph);
 static bool responseIsAffirmative(const string& prompt);
 static void quitAction();
-static void runDijkstra(PathfinderGraph *&graph);
+static void runShortestPath(PathfinderGraph *&graph);
 static void kruskalAction(PathfinderGraph *&graph);
 static void dijkstraAction();
+static void astarAction();
+static void bidirectionalAction();
+static void hierarchyAction(PathfinderGraph *&graph);
 static void mapAction(PathfinderGraph *&graph);
 static void clickAction(const GPoint &pt, PathfinderGraph *&graph);
 static void loadMap(PathfinderGraph *graph, string datafile);
-static Vector<Set< Node *> > processArcs(Vector<Set< Node *> > MST, Arc *out);
+
+/**
+ * How far from a node, in pixels, a click can land and still pick it.
+ */
+
+static const double kClickRadius = 8;
+
+/**
+ * The search that clicking on two nodes runs, which the Dijkstra, A*,
+ * Bidirectional and Hierarchy buttons choose between.
+ */
+
+static ShortestPathFinder::Algorithm searchAlgorithm = ShortestPathFinder::Dijkstra;
 
 
 /**
@@ -70,6 +86,9 @@ int main() {
     
     addButton("Map", mapAction, graph);
     addButton("Dijkstra", dijkstraAction);
+    addButton("A*", astarAction);
+    addButton("Bidirectional", bidirectionalAction);
+    addButton("Hierarchy", hierarchyAction, graph);
     addButton("Kruskal", kruskalAction, graph);
     addButton("Quit", quitAction);
     
@@ -93,6 +112,7 @@ static void loadMap(PathfinderGraph *graph, string datafile) {
     int result = graph->setMapFile(datafile);
     if (result == -1) {
         cout << "That file doesn't want to load, or doesn't exist." << endl;
+        cout << graph->getLoadError() << endl;
         cout << "Make sure you don't use file extensions, just the name of the file." << endl;
         if (responseIsAffirmative("Do you want to try again?")) {
             mapAction(graph);
@@ -101,12 +121,11 @@ static void loadMap(PathfinderGraph *graph, string datafile) {
     
     string map = graph->getMapFile();
     drawPathfinderMap(map);
-    Set<Node *> mapnodes = graph->getNodes();
-    foreach (Node *next in mapnodes) {
+    for (int i = 0; i < graph->numNodes(); i++) {
+        Node *next = graph->getNode(i);
         drawPathfinderNode(next->loc, "Black", next->name);
     }
-    Set<Arc *> maparcs = graph->getArcs();
-    foreach (Arc *route in maparcs) {
+    foreach (Arc *route in graph->getArcs()) {
         drawPathfinderArc(route->start->loc, route->finish->loc, "Black");
     }
 }
@@ -126,11 +145,11 @@ static bool responseIsAffirmative(const string& prompt) {
 
 static void clickAction(const GPoint &pt, PathfinderGraph *&graph) {
     Node *found = findNode(pt, graph);
-    if (found->name != "VOID") {
+    if (found != NULL) {
         drawPathfinderNode(found->loc, "Red");
         graph->setHighlightedNode(found);
         if (graph->checkNodes()) {
-            runDijkstra(graph);
+            runShortestPath(graph);
         }
     }
 }
@@ -141,191 +160,140 @@ static void quitAction() {
     exitGraphics();
 }
 
+/**
+ * The tree is found by a SpanningTreeFinder over the arcs as they were
+ * loaded, one for each pair of cities, and then takes the place of the
+ * map's arcs, so routes found afterwards follow the tree.  Only the
+ * arcs in the tree are described on the console.
+ */
+
 static void kruskalAction(PathfinderGraph *&graph) {
     
     drawPathfinderMap(graph->getMapFile());// reboot mapfile
     
-    Set<Node *> cities = graph->getNodes();
-    Vector<Arc *> routes = graph->getKruskalArcs();// get arcs without return trips
+    const Vector<Arc *>& routes = graph->getKruskalArcs();// get arcs without return trips
     graph->clearArcs();
     
-    foreach(Node *edge in cities) {
-        edge->arcs.clear();
-    }
-    
-    HeapPQueue<Arc *> *pq = new HeapPQueue<Arc *>;
-    
-    for (int i = 0; i < routes.size(); i++) {// pull all of the arcs off, enqueue
-        pq->enqueue(routes[i], arcCmp);// with arcCmp comparitor from cmfn header
+    vector<SpanningTreeFinder::Edge> edges(routes.size());
+    for (int i = 0; i < routes.size(); i++) {
+        SpanningTreeFinder::Edge edge = { routes[i]->cost, routes[i]->start->index,
+                                          routes[i]->finish->index, i };
+        edges[i] = edge;
     }
+    SpanningTreeFinder finder;
+    finder.findTree(graph->numNodes(), edges);
     
-    Vector<Set< Node *> > MST;// Vector of sets with one node per set is initial minimal spanning tree
-    
-    foreach(Node *city in cities) {//populate vector mst
-        Set<Node *> zone;
-        zone.add(city);
-        MST.add(zone);
+    const vector<int>& chosen = finder.getChosen();
+    for (size_t i = 0; i < chosen.size(); i++) {
+        Arc *out = routes[chosen[i]];
+        Arc *back = new Arc;// create the return trip for each arc in the tree
+        back->start = out->finish;
+        back->finish = out->start;
+        back->cost = out->cost;
+        out->start->arcs.add(out);
+        out->finish->arcs.add(back);
+        cout << realToString(out->cost) + ": " + out->start->name + " - " + out->finish->name << endl;
+        drawPathfinderNode(out->start->loc, "Red", out->start->name);// Update the console and map etc...
+        drawPathfinderNode(out->finish->loc, "Red", out->finish->name);
+        drawPathfinderArc(out->start->loc, out->finish->loc, "Red");
     }
-    
-    while (pq->size() != 0) {// whilst there are more arcs in the pqueue, update mst by processing the arcs
-        Arc *out = pq->extractMin(arcCmp);
-        MST = processArcs(MST, out);
+    graph->rebuildCompactGraph();
+    cout << "Minimal spanning tree: " + integerToString(int(chosen.size())) + " arcs, total cost "
+            + realToString(finder.getCost()) + "; " + integerToString(routes.size() - int(chosen.size()))
+            + " arcs not needed" << endl;
+    if (finder.countComponents() > 1) {
+        cout << "The map is in " + integerToString(finder.countComponents())
+                + " pieces, so that's a tree for each." << endl;
     }
-    
-    delete pq;
 }
 
 static void dijkstraAction() {
-    
+    searchAlgorithm = ShortestPathFinder::Dijkstra;
     cout << "Click on starting and finishing location to cue Dijkstra..." << endl;
     
     
 }
-            
-static Vector<Set< Node *> > processArcs(Vector<Set< Node *> > MST, Arc *out) {
-    Vector<Set< Node *> > testMST = MST;// new test mst is only returned if kruskal algorithm is satisfied and adding the arc involves joining 2 sets
-    
-    Arc *back = new Arc;// create new return trip arc for each arc in the pqueue
-    back->start = out->finish;
-    back->finish = out->start;
-    back->cost = out->cost;
-    string distance = realToString(out->cost);
-    int One;// initialise ints for positions on the MST vector
-    int Two;
-    for (int i = 0; i < testMST.size(); i++) {
-        if (testMST[i].contains(out->start)) {
-            Set< Node *> part1 = testMST[i];// pull set from vector if it contains node from start of arc
-            foreach(Node *start in part1) {
-                if (start->name == out->start->name) {
-                    start->arcs.add(out);// add outgoing arc to ercs
-                    One = i;// One int is updated as position in for loop
-                }
-            }
-    }
-        if (testMST[i].contains(back->start)) {
-            Set< Node *> part2 = testMST[i];// pull set if it contains node from finish
-            foreach(Node *finish in part2) {
-                if (finish->name == back->start->name) {
-                    finish->arcs.add(back);
-                    Two = i;// Two int is updated
-                }
-            }
-        }
-    }
-    Set<Node *> newset = testMST[One];
-    if (One != Two) {// If one and two are different, combine and return the new tree
-        newset = testMST[One] += testMST[Two];
-        testMST[One] = newset;
-        testMST.remove(Two);
-        cout << distance + ": " + out->start->name + " - " + out->finish->name << endl;
-        drawPathfinderNode(out->start->loc, "Red", out->start->name);// Update the console and map etc...
-        drawPathfinderNode(out->finish->loc, "Red", out->finish->name);
-        drawPathfinderArc(out->start->loc, out->finish->loc, "Red");
-        return testMST;
-    }
-    else {
-        cout << distance + ": " + out->start->name + " - " + out->finish->name + "(not needed)" << endl;
-        return MST;// Or return the old tree
-    }
+
+static void astarAction() {
+    searchAlgorithm = ShortestPathFinder::AStar;
+    cout << "Click on starting and finishing location to cue A*..." << endl;
+}
+
+static void bidirectionalAction() {
+    searchAlgorithm = ShortestPathFinder::Bidirectional;
+    cout << "Click on starting and finishing location to cue a search from both ends..." << endl;
 }
 
+static void hierarchyAction(PathfinderGraph *&graph) {
+    searchAlgorithm = ShortestPathFinder::Hierarchy;
+    if (graph->getHierarchy().isEmpty()) {
+        cout << "This map has no contraction hierarchy in " << graph->getHierarchyFile()
+             << " (pathfinder-prepare makes one), so both ends will be searched instead." << endl;
+    }
+    cout << "Click on starting and finishing location to cue the hierarchy..." << endl;
+}
+            
 static void mapAction(PathfinderGraph *&graph) {
     cout<< "Please enter the name of the graph data file (without extension): ";
     string mapname = getLine();
     loadMap(graph, mapname);
 }
 
+/**
+ * Returns the node nearest the point clicked, if it's close enough to
+ * have been meant, and NULL otherwise.
+ */
+
 static Node *findNode(const GPoint &pt, PathfinderGraph *&graph) {
-    Node *result = new Node;
-    result->name = "VOID";
-    double x = pt.getX();
-    double y = pt.getY();
-    Set<Node *> graphnodes = graph->getNodes();
-    foreach (Node *next in graphnodes) {
-        GPoint nodeloc = next->loc;
-        double compx = nodeloc.getX();
-        double compy = nodeloc.getY();
-        if (x < compx + 8 && x > compx - 8) {
-            if (y < compy + 8 && y > compy - 8) {
-                result = next;
-            }
-        }
-    }
-    return result;
+    int index = graph->getSpatialIndex().nearest(pt.getX(), pt.getY(), kClickRadius);
+    if (index == -1) return NULL;
+    return graph->getNode(index);
 }
 
-static void runDijkstra(PathfinderGraph *&graph) {
-    Vector<Node *> selection = graph->getSelected();// Pulls vector of 2 selected nodes
+/**
+ * The search itself is left to a ShortestPathFinder, which is kept from
+ * one click to the next so that its arrays are only allocated once per
+ * map.  Only the winning route is described on the console, and after
+ * any other search, how much of the map it explored next to Dijkstra.
+ */
+
+static void runShortestPath(PathfinderGraph *&graph) {
+    static ShortestPathFinder finder;
+    static ShortestPathFinder baseline;
+    const Vector<Node *>& selection = graph->getSelected();// Pulls vector of 2 selected nodes
     Node *start = selection[0];
     Node *destination = selection[1];
-    string dname = destination->name;
-    start->dist = 0;// distance from start is zero
-    
-    Set<Node *> fixednodes;
-    
-    HeapPQueue<Path> *paths = new HeapPQueue<Path>;// instantiate path pqueue
-    Path startpath;
-    startpath.pathcost = 0;// start path distance is zero
-    startpath.addNode(start);
-    paths->enqueue(startpath, pathCmp);// enqueue with pathCmp comparator (in cmpfn.h header)
-    
-    Path result;
-        while (true) {
-        
-            Path newpath = paths->extractMin(pathCmp);
-            string pathstring = newpath.getRoute();
-            cout << "Dequeue the shortest path: " + pathstring << endl;
-            Node *next = newpath.getNode();
-            string query = next->name;
-            if (query == dname) {
-                result = newpath;
-                break;
-            }
-            Set<Arc *> startarcs = next->arcs;
-           
-            fixednodes.add(next);
-            double routedist = newpath.pathcost;
-            string dist = realToString(routedist);
-            cout << "Fix the distance to " + next->name + " at " + dist << endl;
-            cout << "Process the arcs out of " + next->name + " (" + newpath.getNextArcs() << endl;
-                foreach(Arc *arc in startarcs) {
-                    Node *dest = arc->finish;
-                    Path nextpath = newpath;
-                    if (!fixednodes.contains(dest)) {
-                        nextpath.addArc(arc);
-                        nextpath.addNode(dest);
-                        string pathstring = nextpath.getRoute();
-                        cout << "Enqueue the path: " + pathstring << endl;
-                        paths->enqueue(nextpath, pathCmp);
-                    }
-                    else if (fixednodes.contains(dest)) {
-                        cout << "   Ignore " + dest->name + " because it's distance is fixed." << endl;
-                    }
-                    result = newpath;
-        }
+    if (!finder.findPath(*graph, start->index, destination->index, searchAlgorithm)) {
+        cout << "There is no route from " + start->name + " to " + destination->name + "." << endl;
+        return;
     }
-    delete paths;
-    
-    Vector<Arc *> resultarcs = result.getArcPath();
-    Vector<Node *> resultnodes = result.getNodePath();
-    Set<Arc *> maparcs = graph->getArcs();
-    Set<Node *> mapnodes = graph->getNodes();
-    foreach (Node *next in mapnodes) {
-            drawPathfinderNode(next->loc, "Gray", next->name);
+
+    const Vector<Node *>& route = finder.getRoute();
+    string description = "";
+    for (int i = 0; i < route.size(); i++) {
+        description += route[i]->name + (i < route.size() - 1 ? " -> " : "");
     }
-    foreach (Arc *route in maparcs) {
-            drawPathfinderArc(route->start->loc, route->finish->loc, "Gray");
+    cout << "Shortest path: " + description + " (" + realToString(finder.getCost()) + "), "
+            + integerToString(finder.getNodesExpanded()) + " nodes expanded" << endl;
+    if (searchAlgorithm != ShortestPathFinder::Dijkstra) {
+        baseline.findPath(*graph, start->index, destination->index);
+        cout << "Dijkstra would have expanded " + integerToString(baseline.getNodesExpanded())
+                + " of the map's " + integerToString(graph->numNodes()) + " nodes" << endl;
+    }
+
+    for (int i = 0; i < graph->numNodes(); i++) {
+            drawPathfinderNode(graph->getNode(i)->loc, "Gray", graph->getNode(i)->name);
+    }
+    foreach (Arc *arc in graph->getArcs()) {
+            drawPathfinderArc(arc->start->loc, arc->finish->loc, "Gray");
         
     }
-    for (int i = 0; i < resultarcs.size(); i++) {
-        Arc *paint = resultarcs[i];
-        drawPathfinderArc(paint->start->loc, paint->finish->loc, "Red");
+    for (int i = 1; i < route.size(); i++) {
+        drawPathfinderArc(route[i - 1]->loc, route[i]->loc, "Red");
     }
-    for (int n = 0; n < resultnodes.size(); n++) {
-        Node *draw = resultnodes[n];
+    for (int n = 0; n < route.size(); n++) {
+        Node *draw = route[n];
         drawPathfinderNode(draw->loc, "Red");
     }
 
 }
-
-
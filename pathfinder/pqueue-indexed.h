@@ -0,0 +1,154 @@
+/**
+ * File: pqueue-indexed.h
+ * ----------------------
+ * Defines a binary min-heap of small integer ids, each with a priority,
+ * that remembers where every id sits in the heap.  Knowing that lets it
+ * lower the priority of an id that's already queued in place, which is
+ * the decrease-key operation Dijkstra's algorithm relies on, so an id is
+ * never queued more than once.
+ */
+
+#ifndef _pqueue_indexed_h
+#define _pqueue_indexed_h
+
+#include <vector>
+
+class IndexedPQueue {
+public:
+
+/**
+ * Constructor: IndexedPQueue
+ * Usage: IndexedPQueue queue(numIds);
+ * -----------------------------------
+ * Creates an empty queue for the ids 0 through numIds - 1.
+ */
+
+    IndexedPQueue(int numIds = 0) {
+        reset(numIds);
+    }
+
+/**
+ * Method: reset
+ * Usage: queue.reset(numIds);
+ * ---------------------------
+ * Empties the queue and makes room for the ids 0 through numIds - 1.
+ */
+
+    void reset(int numIds) {
+        heap.clear();
+        position.assign(numIds, kAbsent);
+    }
+
+/**
+ * Method: clear
+ * Usage: queue.clear();
+ * ---------------------
+ * Empties the queue, in time proportional to the ids still in it
+ * rather than to all of the ids it could hold.
+ */
+
+    void clear() {
+        for (size_t i = 0; i < heap.size(); i++) {
+            position[heap[i].id] = kAbsent;
+        }
+        heap.clear();
+    }
+
+    bool isEmpty() const { return heap.empty(); }
+    int size() const { return int(heap.size()); }
+    bool contains(int id) const { return position[id] != kAbsent; }
+
+/**
+ * Method: enqueue
+ * Usage: queue.enqueue(id, priority);
+ * -----------------------------------
+ * Adds id to the queue with the given priority or, if it's already
+ * queued, lowers its priority to the given one.  An id already queued
+ * with a lower priority is left as it is.
+ */
+
+    void enqueue(int id, double priority) {
+        int slot = position[id];
+        if (slot == kAbsent) {
+            Entry entry = { priority, id };
+            heap.push_back(entry);
+            bubbleUp(int(heap.size()) - 1, entry);
+        } else if (priority < heap[slot].priority) {
+            heap[slot].priority = priority;
+            bubbleUp(slot, heap[slot]);
+        }
+    }
+
+/**
+ * Method: peekPriority
+ * Usage: double priority = queue.peekPriority();
+ * ----------------------------------------------
+ * Returns the lowest priority in the queue, which must not be empty.
+ */
+
+    double peekPriority() const { return heap[0].priority; }
+
+/**
+ * Method: extractMin
+ * Usage: int id = queue.extractMin();
+ * -----------------------------------
+ * Removes the id with the lowest priority from the queue, which must
+ * not be empty, and returns it.
+ */
+
+    int extractMin() {
+        int id = heap[0].id;
+        position[id] = kAbsent;
+        Entry last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) siftDown(0, last);
+        return id;
+    }
+
+private:
+    enum { kAbsent = -1 };
+
+    struct Entry {
+        double priority;
+        int id;
+    };
+
+    std::vector<Entry> heap;    // heap[0] is the minimum; slot i's children are 2i+1 and 2i+2
+    std::vector<int> position;  // slot of each id in heap, or kAbsent
+
+/**
+ * Both of these carry the moving entry down or up the heap as a hole,
+ * shifting the entries it passes instead of swapping with each one,
+ * and only write it once its slot is found.
+ */
+
+    void bubbleUp(int slot, Entry entry) {
+        while (slot > 0) {
+            int parent = (slot - 1) / 2;
+            if (!(entry.priority < heap[parent].priority)) break;
+            place(slot, heap[parent]);
+            slot = parent;
+        }
+        place(slot, entry);
+    }
+
+    void siftDown(int slot, Entry entry) {
+        int count = int(heap.size());
+        while (true) {
+            int child = 2 * slot + 1;
+            if (child >= count) break;
+            if (child + 1 < count && heap[child + 1].priority < heap[child].priority) child++;
+            if (!(heap[child].priority < entry.priority)) break;
+            place(slot, heap[child]);
+            slot = child;
+        }
+        place(slot, entry);
+    }
+
+    void place(int slot, const Entry& entry) {
+        heap[slot] = entry;
+        position[entry.id] = slot;
+    }
+};
+
+#endif
@@ -0,0 +1,252 @@
+/**
+ * File: shortest-path.cpp
+ * -----------------------
+ * Implements the ShortestPathFinder class.
+ */
+
+#include <algorithm>
+#include "shortest-path.h"
+
+using namespace std;
+
+static const double kUnreached = 1e300;
+
+ShortestPathFinder::ShortestPathFinder() {
+    cost = 0;
+    nodesExpanded = 0;
+}
+
+bool ShortestPathFinder::findPath(const PathfinderGraph& graph, int source, int destination,
+                                  Algorithm algorithm) {
+    const CompactGraph& compact = graph.getCompactGraph();
+    prepare(compact.numNodes());
+    route.clear();
+    cost = 0;
+    nodesExpanded = 0;
+    const ContractionHierarchy& hierarchy = graph.getHierarchy();
+    bool useHierarchy = (algorithm == Hierarchy && !hierarchy.isEmpty());
+    int meet;
+    if (useHierarchy) {
+        meet = searchHierarchy(hierarchy, source, destination);
+    } else if (algorithm == Bidirectional || algorithm == Hierarchy) {
+        meet = searchBothWays(compact, source, destination);
+    } else {
+        double scale = (algorithm == AStar) ? graph.getHeuristicScale() : 0;
+        meet = searchForward(compact, source, destination, scale);
+    }
+    if (meet == -1) return false;
+    cost = dist[meet];
+    if (meet != destination) cost += distBack[meet];
+    buildRoute(graph, meet, useHierarchy ? &hierarchy : NULL);
+    return true;
+}
+
+/**
+ * A* is Dijkstra's algorithm with the frontier ordered by distance plus
+ * estimate rather than by distance alone.  Because the scale never
+ * exceeds any arc's cost per pixel, the estimate can't drop by more
+ * than the cost of any arc taken, so a node is still never reached
+ * more cheaply after it's fixed, and the loop needs no changes.
+ */
+
+int ShortestPathFinder::searchForward(const CompactGraph& compact, int source, int destination,
+                                      double scale) {
+    reach(source, -1, 0, scale * compact.distance(source, destination));
+    while (!frontier.isEmpty()) {
+        int node = frontier.extractMin();
+        fixed[node] = true;
+        if (node == destination) return destination;
+        nodesExpanded++;
+        for (int arc = compact.arcsBegin(node); arc < compact.arcsEnd(node); arc++) {
+            int next = compact.target(arc);
+            double distance = dist[node] + compact.cost(arc);
+            if (!fixed[next] && distance < dist[next]) {
+                double estimate = (scale == 0) ? 0 : scale * compact.distance(next, destination);
+                reach(next, node, distance, estimate);
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * Each round expands whichever frontier has the nearer node, and every
+ * arc either search relaxes is checked for a route through to a node
+ * the other search has reached.  Any route still undiscovered must
+ * leave both frontiers, so it costs at least the sum of their two
+ * lowest distances, and once that sum reaches the best route found so
+ * far, the search is over.  The arcs in a data file always run both
+ * ways, so the search back from the destination follows the same arcs
+ * as the one from the source.  Returns the node where the best route
+ * crosses from one search to the other, or -1 if there's no route.
+ */
+
+int ShortestPathFinder::searchBothWays(const CompactGraph& compact, int source, int destination) {
+    reach(source, -1, 0, 0);
+    startBackward(destination);
+    double best = kUnreached;
+    int meet = -1;
+    if (source == destination) {
+        best = 0;
+        meet = source;
+    }
+    while (!frontier.isEmpty() && !frontierBack.isEmpty()
+           && frontier.peekPriority() + frontierBack.peekPriority() < best) {
+        bool forward = frontier.peekPriority() <= frontierBack.peekPriority();
+        IndexedPQueue& queue = forward ? frontier : frontierBack;
+        vector<double>& near = forward ? dist : distBack;
+        vector<double>& far = forward ? distBack : dist;
+        vector<int>& from = forward ? parent : parentBack;
+        vector<char>& done = forward ? fixed : fixedBack;
+        int node = queue.extractMin();
+        done[node] = true;
+        nodesExpanded++;
+        for (int arc = compact.arcsBegin(node); arc < compact.arcsEnd(node); arc++) {
+            int next = compact.target(arc);
+            double distance = near[node] + compact.cost(arc);
+            if (!done[next] && distance < near[next]) {
+                if (near[next] == kUnreached && far[next] == kUnreached) touched.push_back(next);
+                near[next] = distance;
+                from[next] = node;
+                queue.enqueue(next, distance);
+            }
+            if (far[next] != kUnreached && near[next] + far[next] < best) {
+                best = near[next] + far[next];
+                meet = next;
+            }
+        }
+    }
+    return meet;
+}
+
+/**
+ * In a contraction hierarchy both searches climb, so they can't stop
+ * when their frontiers meet; instead each carries on until its own
+ * frontier is no nearer than the best route found, and the best route
+ * is the cheapest through any node both of them fixed.  A node that
+ * some higher neighbor already reaches more cheaply than the search
+ * did can't be on a shortest route through this search's side, so its
+ * arcs aren't followed, which is the "stall on demand" that keeps the
+ * searches small.  The route found runs along upward arcs, some of them
+ * shortcuts, which buildRoute expands.
+ */
+
+int ShortestPathFinder::searchHierarchy(const ContractionHierarchy& hierarchy, int source,
+                                        int destination) {
+    reach(source, -1, 0, 0);
+    startBackward(destination);
+    double best = kUnreached;
+    int meet = -1;
+    while (true) {
+        bool forwardLeft = !frontier.isEmpty() && frontier.peekPriority() < best;
+        bool backwardLeft = !frontierBack.isEmpty() && frontierBack.peekPriority() < best;
+        if (!forwardLeft && !backwardLeft) break;
+        bool forward = forwardLeft
+                       && (!backwardLeft || frontier.peekPriority() <= frontierBack.peekPriority());
+        IndexedPQueue& queue = forward ? frontier : frontierBack;
+        vector<double>& near = forward ? dist : distBack;
+        vector<double>& far = forward ? distBack : dist;
+        vector<int>& from = forward ? parent : parentBack;
+        vector<char>& done = forward ? fixed : fixedBack;
+        int node = queue.extractMin();
+        done[node] = true;
+        nodesExpanded++;
+        if (far[node] != kUnreached && near[node] + far[node] < best) {
+            best = near[node] + far[node];
+            meet = node;
+        }
+        bool stalled = false;
+        for (int arc = hierarchy.arcsBegin(node); arc < hierarchy.arcsEnd(node); arc++) {
+            if (near[hierarchy.target(arc)] + hierarchy.cost(arc) < near[node]) {
+                stalled = true;
+                break;
+            }
+        }
+        if (stalled) continue;
+        for (int arc = hierarchy.arcsBegin(node); arc < hierarchy.arcsEnd(node); arc++) {
+            int next = hierarchy.target(arc);
+            double distance = near[node] + hierarchy.cost(arc);
+            if (distance < near[next]) {
+                if (near[next] == kUnreached && far[next] == kUnreached) touched.push_back(next);
+                near[next] = distance;
+                from[next] = node;
+                queue.enqueue(next, distance);
+            }
+        }
+    }
+    return meet;
+}
+
+void ShortestPathFinder::startBackward(int destination) {
+    if (dist[destination] == kUnreached) touched.push_back(destination);
+    distBack[destination] = 0;
+    frontierBack.enqueue(destination, 0);
+}
+
+/**
+ * Only the nodes the previous search touched need putting back, which
+ * keeps a short search on a big graph from costing a pass over every
+ * node.
+ */
+
+void ShortestPathFinder::prepare(int numNodes) {
+    if (int(dist.size()) != numNodes) {
+        dist.assign(numNodes, kUnreached);
+        parent.assign(numNodes, -1);
+        fixed.assign(numNodes, false);
+        distBack.assign(numNodes, kUnreached);
+        parentBack.assign(numNodes, -1);
+        fixedBack.assign(numNodes, false);
+        frontier.reset(numNodes);
+        frontierBack.reset(numNodes);
+    } else {
+        for (size_t i = 0; i < touched.size(); i++) {
+            int node = touched[i];
+            dist[node] = kUnreached;
+            parent[node] = -1;
+            fixed[node] = false;
+            distBack[node] = kUnreached;
+            parentBack[node] = -1;
+            fixedBack[node] = false;
+        }
+        frontier.clear();
+        frontierBack.clear();
+    }
+    touched.clear();
+}
+
+void ShortestPathFinder::reach(int node, int from, double distance, double estimate) {
+    if (dist[node] == kUnreached && distBack[node] == kUnreached) touched.push_back(node);
+    dist[node] = distance;
+    parent[node] = from;
+    frontier.enqueue(node, distance + estimate);
+}
+
+/**
+ * The route runs back along the forward parents from meet to the
+ * source, and on along the backward ones from meet to the destination.
+ * A one-way search meets the other end at the destination itself.
+ * After a search of a hierarchy, each step along the way is an upward
+ * arc that may be a shortcut, and is unpacked into the arcs it stands
+ * for.
+ */
+
+void ShortestPathFinder::buildRoute(const PathfinderGraph& graph, int meet,
+                                    const ContractionHierarchy *hierarchy) {
+    path.clear();
+    for (int node = meet; node != -1; node = parent[node]) path.push_back(node);
+    reverse(path.begin(), path.end());
+    for (int node = parentBack[meet]; node != -1; node = parentBack[node]) path.push_back(node);
+    if (hierarchy != NULL) {
+        vector<int> steps;
+        steps.swap(path);
+        path.push_back(steps[0]);
+        for (size_t i = 1; i < steps.size(); i++) {
+            hierarchy->unpack(steps[i - 1], steps[i], path);
+        }
+    }
+    route = Vector<Node *>(int(path.size()), NULL);
+    for (size_t i = 0; i < path.size(); i++) {
+        route[i] = graph.getNode(path[i]);
+    }
+}
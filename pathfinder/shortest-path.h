@@ -0,0 +1,113 @@
+/**
+ * File: shortest-path.h
+ * ---------------------
+ * Defines the engine Pathfinder uses to find shortest routes.  It works
+ * on the graph's CompactGraph and its dense node numbering, keeping
+ * each node's best known distance and the node it was reached from in
+ * arrays, and the frontier in an IndexedPQueue, so a search allocates
+ * nothing per node and each node is queued at most once.  The route itself is only
+ * pieced together, by following parents back from the destination,
+ * once the search is over.
+ */
+
+#ifndef _shortest_path_h
+#define _shortest_path_h
+
+#include <vector>
+#include "vector.h"
+#include "pathfinder-graph.h"
+#include "pqueue-indexed.h"
+
+class ShortestPathFinder {
+public:
+
+/**
+ * Type: Algorithm
+ * ---------------
+ * Dijkstra explores outwards from the source evenly in every direction.
+ * AStar adds to each node's distance an estimate of how far it still
+ * is from the destination, the straight-line distance scaled by the
+ * graph's heuristic scale, and so explores towards the destination
+ * first.  Bidirectional runs Dijkstra outwards from the source and,
+ * at the same time, back from the destination, and stops once the two
+ * searches can't improve on the best route joining them; each covers
+ * about half the distance, so together they explore far less of a
+ * road-like map.  Hierarchy searches the graph's contraction
+ * hierarchy from both ends, which explores only a few dozen nodes
+ * even on a large map; a graph without one is searched Bidirectional
+ * instead.  All four find a shortest route.
+ */
+
+    enum Algorithm { Dijkstra, AStar, Bidirectional, Hierarchy };
+
+    ShortestPathFinder();
+
+/**
+ * Method: findPath
+ * Usage: if (finder.findPath(graph, source, destination)) ...
+ *        if (finder.findPath(graph, source, destination, ShortestPathFinder::AStar)) ...
+ * -----------------------------------------------------------------------------------
+ * Searches the compact form of graph for a shortest route from the
+ * node numbered source to the node numbered destination, and returns
+ * whether there is one at all.  The same finder can be used for any
+ * number of searches, on any number of graphs; the arrays are only
+ * reallocated when the number of nodes changes.
+ */
+
+    bool findPath(const PathfinderGraph& graph, int source, int destination,
+                  Algorithm algorithm = Dijkstra);
+
+/**
+ * Method: getCost
+ * Usage: double cost = finder.getCost();
+ * --------------------------------------
+ * Returns the cost of the route found by the last successful search.
+ */
+
+    double getCost() const { return cost; }
+
+/**
+ * Method: getRoute
+ * Usage: Vector<Node *> route = finder.getRoute();
+ * ------------------------------------------------
+ * Returns the nodes along the route found by the last successful
+ * search, from its source to its destination.
+ */
+
+    const Vector<Node *>& getRoute() const { return route; }
+
+/**
+ * Method: getNodesExpanded
+ * Usage: int expanded = finder.getNodesExpanded();
+ * ------------------------------------------------
+ * Returns how many nodes the last search fixed and took the arcs out
+ * of, which is the measure of how much of the graph it explored.
+ */
+
+    int getNodesExpanded() const { return nodesExpanded; }
+
+private:
+    std::vector<double> dist;    // best known distance to each node
+    std::vector<int> parent;     // the node each one was reached from, or -1
+    std::vector<char> fixed;     // whether each node's distance is final
+    std::vector<double> distBack;    // the same three, for the search back from the destination
+    std::vector<int> parentBack;
+    std::vector<char> fixedBack;
+    std::vector<int> touched;    // every node the last search wrote to
+    std::vector<int> path;       // the route's node numbers, while it's being built
+    IndexedPQueue frontier;
+    IndexedPQueue frontierBack;
+    Vector<Node *> route;
+    double cost;
+    int nodesExpanded;
+
+    void prepare(int numNodes);
+    int searchForward(const CompactGraph& compact, int source, int destination, double scale);
+    int searchBothWays(const CompactGraph& compact, int source, int destination);
+    int searchHierarchy(const ContractionHierarchy& hierarchy, int source, int destination);
+    void reach(int node, int from, double distance, double estimate);
+    void buildRoute(const PathfinderGraph& graph, int meet, const ContractionHierarchy *hierarchy);
+    void startBackward(int destination);
+};
+
+#endif
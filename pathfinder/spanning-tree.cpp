@@ -0,0 +1,98 @@
+/**
+ * File: spanning-tree.cpp
+ * -----------------------
+ * Implements the SpanningTreeFinder class.
+ */
+
+#include <algorithm>
+#include "spanning-tree.h"
+
+using namespace std;
+
+/**
+ * Ranges of edges no longer than this are simply sorted, since there's
+ * too little left in them for filtering to save anything.
+ */
+
+static const int kSortThreshold = 256;
+
+/**
+ * Orders edges by cost and then by id, which makes every edge distinct
+ * and the tree the same whichever way the edges are shuffled.
+ */
+
+static bool lighter(const SpanningTreeFinder::Edge& one, const SpanningTreeFinder::Edge& two) {
+    if (one.cost != two.cost) return one.cost < two.cost;
+    return one.id < two.id;
+}
+
+struct NoHeavierThan {
+    SpanningTreeFinder::Edge pivot;
+    NoHeavierThan(const SpanningTreeFinder::Edge& pivot) : pivot(pivot) { }
+    bool operator()(const SpanningTreeFinder::Edge& edge) const { return !lighter(pivot, edge); }
+};
+
+SpanningTreeFinder::SpanningTreeFinder() {
+    cost = 0;
+    numComponents = 0;
+}
+
+void SpanningTreeFinder::findTree(int numNodes, vector<Edge>& edges) {
+    components.reset(numNodes);
+    chosen.clear();
+    cost = 0;
+    filterKruskal(edges, 0, int(edges.size()));
+    numComponents = components.countSets();
+}
+
+/**
+ * The pivot is the middle of three edges from the range, so it's never
+ * the heaviest in it and both halves always have something in them.
+ * Once the tree connects every node, whatever's left is skipped.
+ */
+
+void SpanningTreeFinder::filterKruskal(vector<Edge>& edges, int begin, int end) {
+    if (components.countSets() == 1) return;
+    if (end - begin <= kSortThreshold) {
+        kruskal(edges, begin, end);
+        return;
+    }
+    Edge first = edges[begin];
+    Edge middle = edges[begin + (end - begin) / 2];
+    Edge last = edges[end - 1];
+    Edge pivot;
+    if (lighter(first, middle)) {
+        pivot = lighter(middle, last) ? middle : (lighter(first, last) ? last : first);
+    } else {
+        pivot = lighter(first, last) ? first : (lighter(middle, last) ? last : middle);
+    }
+    int split = int(partition(edges.begin() + begin, edges.begin() + end, NoHeavierThan(pivot))
+                    - edges.begin());
+    filterKruskal(edges, begin, split);
+    filterKruskal(edges, split, filter(edges, split, end));
+}
+
+void SpanningTreeFinder::kruskal(vector<Edge>& edges, int begin, int end) {
+    sort(edges.begin() + begin, edges.begin() + end, lighter);
+    for (int i = begin; i < end && components.countSets() > 1; i++) {
+        if (components.merge(edges[i].one, edges[i].two)) {
+            chosen.push_back(edges[i].id);
+            cost += edges[i].cost;
+        }
+    }
+}
+
+/**
+ * Moves the edges in the range that still join two separate trees to
+ * its front, and returns where they end.
+ */
+
+int SpanningTreeFinder::filter(vector<Edge>& edges, int begin, int end) {
+    int kept = begin;
+    for (int i = begin; i < end; i++) {
+        if (!components.connected(edges[i].one, edges[i].two)) {
+            edges[kept++] = edges[i];
+        }
+    }
+    return kept;
+}
@@ -0,0 +1,88 @@
+/**
+ * File: spanning-tree.h
+ * ---------------------
+ * Defines the engine Pathfinder uses to find a minimal spanning tree,
+ * or a forest of them if the map falls into pieces.  It works on plain
+ * weighted edges between dense node numbers, and keeps track of which
+ * nodes are already connected with a DisjointSet rather than with sets
+ * of nodes, so each arc costs a couple of nearly constant-time finds.
+ *
+ * The arcs are chosen Kruskal's way, cheapest first, but not by
+ * sorting them all up front.  Filter-Kruskal splits them around a
+ * pivot cost and deals with the cheaper half first; by the time the
+ * dearer half's turn comes, most of it usually joins nodes that are
+ * already connected, and those arcs are thrown away without ever being
+ * sorted.  On a map with many more arcs than nodes, that leaves most of
+ * the work of sorting undone.
+ */
+
+#ifndef _spanning_tree_h
+#define _spanning_tree_h
+
+#include <vector>
+#include "disjoint-set.h"
+
+class SpanningTreeFinder {
+public:
+
+/**
+ * Type: Edge
+ * ----------
+ * An edge between the nodes numbered one and two, which the finder
+ * refers to by its id.
+ */
+
+    struct Edge {
+        double cost;
+        int one;
+        int two;
+        int id;
+    };
+
+    SpanningTreeFinder();
+
+/**
+ * Method: findTree
+ * Usage: finder.findTree(numNodes, edges);
+ * ----------------------------------------
+ * Finds a minimal spanning forest of the nodes numbered 0 through
+ * numNodes - 1 joined by the given edges, which are reordered along
+ * the way.  Edges of equal cost are taken in order of id.
+ */
+
+    void findTree(int numNodes, std::vector<Edge>& edges);
+
+/**
+ * Method: getChosen
+ * Usage: const std::vector<int>& chosen = finder.getChosen();
+ * -----------------------------------------------------------
+ * Returns the ids of the edges in the tree the last call to findTree
+ * found, cheapest first.
+ */
+
+    const std::vector<int>& getChosen() const { return chosen; }
+
+    double getCost() const { return cost; }
+
+/**
+ * Method: countComponents
+ * Usage: int pieces = finder.countComponents();
+ * ---------------------------------------------
+ * Returns how many separate trees the last forest found is made of,
+ * which is 1 if every node is connected to every other.
+ */
+
+    int countComponents() const { return numComponents; }
+
+private:
+    DisjointSet components;
+    std::vector<int> chosen;
+    double cost;
+    int numComponents;
+
+    void filterKruskal(std::vector<Edge>& edges, int begin, int end);
+    void kruskal(std::vector<Edge>& edges, int begin, int end);
+    int filter(std::vector<Edge>& edges, int begin, int end);
+};
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * File: spatial-index.cpp
+ * -----------------------
+ * Implements the SpatialIndex class.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "spatial-index.h"
+
+using namespace std;
+
+SpatialIndex::SpatialIndex() {
+    left = top = 0;
+    cellSize = 1;
+    numCols = numRows = 0;
+}
+
+/**
+ * A map whose nodes lie along a line has a bounding box with next to
+ * no area, so cells are never made smaller than the box's longer side
+ * split as many ways as there are nodes, which keeps the number of
+ * cells within a few times the number of nodes.
+ */
+
+void SpatialIndex::build(const Vector<Node *>& nodes) {
+    int numNodes = nodes.size();
+    xs.resize(numNodes);
+    ys.resize(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        xs[i] = nodes[i]->loc.getX();
+        ys[i] = nodes[i]->loc.getY();
+    }
+    cellStart.clear();
+    cellNodes.clear();
+    numCols = numRows = 0;
+    if (numNodes == 0) return;
+    left = *min_element(xs.begin(), xs.end());
+    top = *min_element(ys.begin(), ys.end());
+    double width = *max_element(xs.begin(), xs.end()) - left;
+    double height = *max_element(ys.begin(), ys.end()) - top;
+    cellSize = max(sqrt(width * height / numNodes), max(width, height) / numNodes);
+    if (cellSize <= 0) cellSize = 1;
+    numCols = int(width / cellSize) + 1;
+    numRows = int(height / cellSize) + 1;
+
+    vector<int> cellOf(numNodes);
+    cellStart.assign(numCols * numRows + 1, 0);
+    for (int i = 0; i < numNodes; i++) {
+        cellOf[i] = rowOf(ys[i]) * numCols + colOf(xs[i]);
+        cellStart[cellOf[i] + 1]++;
+    }
+    for (int cell = 0; cell < numCols * numRows; cell++) {
+        cellStart[cell + 1] += cellStart[cell];
+    }
+    cellNodes.resize(numNodes);
+    vector<int> next(cellStart.begin(), cellStart.end() - 1);
+    for (int i = 0; i < numNodes; i++) {
+        cellNodes[next[cellOf[i]]++] = i;
+    }
+}
+
+int SpatialIndex::nearest(double x, double y, double radius) const {
+    if (numCols == 0) return -1;
+    int best = -1;
+    double bestDistance = radius * radius;
+    int firstRow = rowOf(y - radius), lastRow = rowOf(y + radius);
+    int firstCol = colOf(x - radius), lastCol = colOf(x + radius);
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int col = firstCol; col <= lastCol; col++) {
+            int cell = row * numCols + col;
+            for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                int node = cellNodes[k];
+                double dx = xs[node] - x;
+                double dy = ys[node] - y;
+                double distance = dx * dx + dy * dy;
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = node;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * Both clamp to the grid, so a point off the edge of the map falls in
+ * the nearest cell along the edge.
+ */
+
+int SpatialIndex::colOf(double x) const {
+    double col = floor((x - left) / cellSize);
+    return int(max(0.0, min(col, double(numCols - 1))));
+}
+
+int SpatialIndex::rowOf(double y) const {
+    double row = floor((y - top) / cellSize);
+    return int(max(0.0, min(row, double(numRows - 1))));
+}
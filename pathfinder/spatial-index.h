@@ -0,0 +1,59 @@
+/**
+ * File: spatial-index.h
+ * ---------------------
+ * Defines an index of where a graph's nodes are on the screen, for
+ * finding the node nearest a point, such as where the user clicked,
+ * without looking at every node.  The bounding box of the nodes is cut
+ * into a uniform grid of square cells, sized so there are about as
+ * many cells as nodes, and each cell lists the nodes inside it; a query
+ * only looks in the cells its circle overlaps.  The lists are stored
+ * back to back in one array, in the same compressed sparse row form as
+ * a CompactGraph, with the nodes' locations copied alongside.
+ */
+
+#ifndef _spatial_index_h
+#define _spatial_index_h
+
+#include <vector>
+#include "graphtypes.h"
+#include "vector.h"
+
+class SpatialIndex {
+public:
+    SpatialIndex();
+
+/**
+ * Method: build
+ * Usage: index.build(nodes);
+ * --------------------------
+ * Replaces the contents with the locations of the given nodes, each of
+ * which must already be numbered with its position in nodes.  Nodes
+ * that move afterwards aren't seen until the next build.
+ */
+
+    void build(const Vector<Node *>& nodes);
+
+/**
+ * Method: nearest
+ * Usage: int node = index.nearest(x, y, radius);
+ * ----------------------------------------------
+ * Returns the number of the node nearest to (x, y), if it's less than
+ * radius away, and -1 if no node is.
+ */
+
+    int nearest(double x, double y, double radius) const;
+
+private:
+    double left, top;             // the corner of the bounding box
+    double cellSize;
+    int numCols, numRows;
+    std::vector<int> cellStart;   // numCols * numRows + 1 entries; cell c's nodes start at cellStart[c]
+    std::vector<int> cellNodes;
+    std::vector<double> xs;       // location of each node, by number
+    std::vector<double> ys;
+
+    int colOf(double x) const;
+    int rowOf(double y) const;
+};
+
+#endif